@@ -24,6 +24,8 @@
 
 static const char pfm_sig[4] = "PF\n";
 
+#define MAX_VARIANTS 7
+
 static void print_usage(const char *argv0) {
     fprintf(stderr, "Usage: %s [options] [--] <input.png|input.pfm> <output.jxl>\n", argv0);
     fprintf(stderr, "Options:\n");
@@ -38,10 +40,56 @@ static void print_usage(const char *argv0) {
     fprintf(stderr, "                       (default: assume PNG unless input filename ends with .pfm)\n");
     fprintf(stderr, "    --linear       Assume input is in Linear Light\n");
     fprintf(stderr, "                       (default: assume sRGB transfer, regardless of PNG tags)\n");
+    fprintf(stderr, "    --fast-decode  Prefer prefix codes to ANS unless ANS is much smaller\n");
+    fprintf(stderr, "    --entropy-preset=N\n");
+    fprintf(stderr, "                   Use built-in entropy codes, and write symbols as they are computed.\n");
+    fprintf(stderr, "                       1 is trained on photos, 2 on graphics. (default: 0, off)\n");
+    fprintf(stderr, "    --distance=D   Allow distance D from the original, from 0.1 to 25\n");
+    fprintf(stderr, "                       Larger distances give smaller files at lower quality. (default: 1.0)\n");
+    fprintf(stderr, "    --target-size=N\n");
+    fprintf(stderr, "                   Aim for about N bytes, picking the distance to match (default: 0, off)\n");
+    fprintf(stderr, "    --effort=N     Trade speed for size, from 1 (fastest) to 5 (smallest) (default: 3)\n");
+    fprintf(stderr, "                       Effort 1 uses built-in entropy codes unless --entropy-preset is set.\n");
+    fprintf(stderr, "    --upsampling=N Code the image at 1/N the size, for the decoder to upsample. N is 1, 2, 4, or 8\n");
+    fprintf(stderr, "                       Tiles grow by N in each direction. (default: 1)\n");
+    fprintf(stderr, "    --passes=N     Split HF coefficients into N passes, low frequencies first, from 1 to 3\n");
+    fprintf(stderr, "                       Decoders can show a coarser image before the rest arrives. (default: 1)\n");
+    fprintf(stderr, "    --lf-frame     Write an 8x smaller LF frame first, for a preview at the start of the file\n");
+    fprintf(stderr, "                       Requires --one-frame, and no --upsampling.\n");
+    fprintf(stderr, "    --preview      Embed a preview, at most 256 pixels on its longer side\n");
+    fprintf(stderr, "                       Requires --one-frame.\n");
+    fprintf(stderr, "    --pyramid=N    Also write N lower levels, each half the size of the one before, in tiles\n");
+    fprintf(stderr, "                       Tiles go next to the output, as OUTPUT.LEVEL_X_Y.jxl. Requires --tile-size.\n");
+    fprintf(stderr, "    --tile-cache=N Reuse the encoded frames of up to N recent tiles for identical tiles\n");
+    fprintf(stderr, "                       Requires --tile-size. (default: 0, off)\n");
+    fprintf(stderr, "    --variant=D:FILE\n");
+    fprintf(stderr, "                   Also encode the image at distance D into FILE, up to %d times\n", MAX_VARIANTS);
+    fprintf(stderr, "                       Shares the color conversion and DCT with the main output, but not --target-size.\n");
     fprintf(stderr, "    --tag-icc-from=FILE.icc\n");
     fprintf(stderr, "                   Use FILE as the suggested ICC profile. Input still assumed to be sRGB.\n");
 }
 
+/* opaque is the output filename, which the tiles of each level are named after */
+static HYDStatusCode write_pyramid_tile(void *opaque, int level, uint32_t tile_x, uint32_t tile_y,
+                                        const uint8_t *data, size_t size) {
+    const char *out_fname = opaque;
+    char tile_fname[4096];
+    snprintf(tile_fname, sizeof(tile_fname), "%s.%d_%u_%u.jxl", out_fname, level, (unsigned int)tile_x,
+        (unsigned int)tile_y);
+    FILE *tile_out = fopen(tile_fname, "wb");
+    if (!tile_out) {
+        fprintf(stderr, "error opening file for writing: %s\n", tile_fname);
+        return HYD_API_ERROR;
+    }
+    size_t written = fwrite(data, size, 1, tile_out);
+    fclose(tile_out);
+    if (!written) {
+        fprintf(stderr, "error writing to file: %s\n", tile_fname);
+        return HYD_API_ERROR;
+    }
+    return HYD_OK;
+}
+
 static int init_spng_stream(spng_ctx **ctx, const char **error_msg, FILE *fin, struct spng_ihdr *ihdr) {
 
     spng_ctx *spng_context = spng_ctx_new(0);
@@ -74,6 +122,12 @@ int main(int argc, const char *argv[]) {
     int ret = 1;
     FILE *fout = stdout, *fin = stdin;
     const char *error_msg = NULL;
+    HYDEncoder *variants[MAX_VARIANTS] = { NULL };
+    FILE *variant_fouts[MAX_VARIANTS] = { NULL };
+    uint8_t *variant_buffers[MAX_VARIANTS] = { NULL };
+    float variant_distances[MAX_VARIANTS];
+    const char *variant_fnames[MAX_VARIANTS];
+    int num_variants = 0;
     spng_ctx *spng_context = NULL;
 
     fprintf(stderr, "libhydrium version %s\n", HYDRIUM_VERSION_STRING);
@@ -86,6 +140,17 @@ int main(int argc, const char *argv[]) {
     int one_frame = 0;
     int pfm = -1;
     int linear = 0;
+    int fast_decode = 0;
+    int lf_frame = 0;
+    int preview = 0;
+    long entropy_preset = 0;
+    float distance = 0.f;
+    long effort = 0;
+    unsigned long long target_size = 0;
+    long upsampling = 1;
+    long passes = 1;
+    long pyramid = 0;
+    long tile_cache = 0;
     int endianness = 0;
     long tilesize = -1;
     int argp = 0;
@@ -133,6 +198,134 @@ int main(int argc, const char *argv[]) {
             pfm = 0;
         } else if (!strcmp(argv[argp], "--linear")) {
             linear = 1;
+        } else if (!strcmp(argv[argp], "--fast-decode")) {
+            fast_decode = 1;
+        } else if (!strcmp(argv[argp], "--lf-frame")) {
+            lf_frame = 1;
+        } else if (!strcmp(argv[argp], "--preview")) {
+            preview = 1;
+        } else if (!strncmp(argv[argp], "--entropy-preset=", 17)) {
+            errno = 0;
+            entropy_preset = strtol(argv[argp] + 17, NULL, 10);
+            if (errno) {
+                fprintf(stderr, "Invalid integer: %s\n", argv[argp] + 17);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (entropy_preset < 0 || entropy_preset > 2) {
+                fprintf(stderr, "Invalid entropy preset, must be 0-2: %s\n", argv[argp] + 17);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--distance=", 11)) {
+            errno = 0;
+            char *end;
+            distance = strtof(argv[argp] + 11, &end);
+            if (errno || end == argv[argp] + 11 || *end) {
+                fprintf(stderr, "Invalid number: %s\n", argv[argp] + 11);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (!(distance >= 0.1f && distance <= 25.f)) {
+                fprintf(stderr, "Invalid distance, must be 0.1-25: %s\n", argv[argp] + 11);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--target-size=", 14)) {
+            errno = 0;
+            char *end;
+            target_size = strtoull(argv[argp] + 14, &end, 10);
+            if (errno || end == argv[argp] + 14 || *end || target_size > SIZE_MAX) {
+                fprintf(stderr, "Invalid size: %s\n", argv[argp] + 14);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--effort=", 9)) {
+            errno = 0;
+            effort = strtol(argv[argp] + 9, NULL, 10);
+            if (errno) {
+                fprintf(stderr, "Invalid integer: %s\n", argv[argp] + 9);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (effort < 1 || effort > 5) {
+                fprintf(stderr, "Invalid effort, must be 1-5: %s\n", argv[argp] + 9);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--upsampling=", 13)) {
+            errno = 0;
+            upsampling = strtol(argv[argp] + 13, NULL, 10);
+            if (errno) {
+                fprintf(stderr, "Invalid integer: %s\n", argv[argp] + 13);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (upsampling != 1 && upsampling != 2 && upsampling != 4 && upsampling != 8) {
+                fprintf(stderr, "Invalid upsampling, must be 1, 2, 4, or 8: %s\n", argv[argp] + 13);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--passes=", 9)) {
+            errno = 0;
+            passes = strtol(argv[argp] + 9, NULL, 10);
+            if (errno) {
+                fprintf(stderr, "Invalid integer: %s\n", argv[argp] + 9);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (passes < 1 || passes > 3) {
+                fprintf(stderr, "Invalid passes, must be 1-3: %s\n", argv[argp] + 9);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--pyramid=", 10)) {
+            errno = 0;
+            pyramid = strtol(argv[argp] + 10, NULL, 10);
+            if (errno) {
+                fprintf(stderr, "Invalid integer: %s\n", argv[argp] + 10);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (pyramid < 0 || pyramid > 30) {
+                fprintf(stderr, "Invalid pyramid levels, must be 0-30: %s\n", argv[argp] + 10);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--tile-cache=", 13)) {
+            errno = 0;
+            tile_cache = strtol(argv[argp] + 13, NULL, 10);
+            if (errno) {
+                fprintf(stderr, "Invalid integer: %s\n", argv[argp] + 13);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (tile_cache < 0 || tile_cache > 65536) {
+                fprintf(stderr, "Invalid tile cache size, must be 0-65536: %s\n", argv[argp] + 13);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+        } else if (!strncmp(argv[argp], "--variant=", 10)) {
+            if (num_variants == MAX_VARIANTS) {
+                fprintf(stderr, "Too many variants, at most %d are allowed\n", MAX_VARIANTS);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            errno = 0;
+            char *end;
+            float variant_distance = strtof(argv[argp] + 10, &end);
+            if (errno || end == argv[argp] + 10 || *end != ':' || !end[1]) {
+                fprintf(stderr, "Invalid variant, must be DISTANCE:FILE: %s\n", argv[argp] + 10);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            if (!(variant_distance >= 0.1f && variant_distance <= 25.f)) {
+                fprintf(stderr, "Invalid distance, must be 0.1-25: %s\n", argv[argp] + 10);
+                fprintf(stderr, "Please run: %s --help\n", argv[0]);
+                return 2;
+            }
+            variant_distances[num_variants] = variant_distance;
+            variant_fnames[num_variants++] = end + 1;
         } else if (!strncmp(argv[argp], "--tag-icc-from=", 15)) {
             icc_from_fname = argv[argp] + 15;
         } else {
@@ -155,6 +348,43 @@ int main(int argc, const char *argv[]) {
         return 2;
     }
 
+    if (!one_frame && lf_frame) {
+        fprintf(stderr, "--lf-frame requires --one-frame\n");
+        return 2;
+    }
+
+    if (!one_frame && preview) {
+        fprintf(stderr, "--preview requires --one-frame\n");
+        return 2;
+    }
+
+    if (pyramid && tilesize < 0) {
+        fprintf(stderr, "--pyramid requires --tile-size\n");
+        return 2;
+    }
+
+    if (tile_cache && tilesize < 0) {
+        fprintf(stderr, "--tile-cache requires --tile-size\n");
+        return 2;
+    }
+
+    if (pyramid && (!out_fname || !strcmp(out_fname, "-"))) {
+        fprintf(stderr, "--pyramid requires an output file\n");
+        return 2;
+    }
+
+    if (pyramid && upsampling > 1) {
+        fprintf(stderr, "--pyramid and --upsampling are incompatible\n");
+        fprintf(stderr, "Please run: %s --help\n", argv[0]);
+        return 2;
+    }
+
+    if (lf_frame && upsampling > 1) {
+        fprintf(stderr, "--lf-frame and --upsampling are incompatible\n");
+        fprintf(stderr, "Please run: %s --help\n", argv[0]);
+        return 2;
+    }
+
     if (in_fname && pfm < 0) {
         size_t len = strlen(in_fname);
         if (len > 3) {
@@ -278,8 +508,18 @@ int main(int argc, const char *argv[]) {
     metadata.linear_light = linear;
     metadata.tile_size_shift_x = one_frame ? -1 : tilesize;
     metadata.tile_size_shift_y = one_frame ? -1 : tilesize;
-    const uint32_t size_shift_x = metadata.tile_size_shift_x < 0 ? 3 : metadata.tile_size_shift_x;
-    const uint32_t size_shift_y = metadata.tile_size_shift_y < 0 ? 3 : metadata.tile_size_shift_y;
+    metadata.fast_decode = fast_decode;
+    metadata.lf_frame = lf_frame;
+    metadata.preview = preview;
+    metadata.entropy_preset = entropy_preset;
+    metadata.distance = distance;
+    metadata.effort = effort;
+    metadata.upsampling = upsampling;
+    metadata.passes = passes;
+    /* tiles are in input pixels, so they grow with the upsampling factor */
+    const uint32_t upsampling_shift = upsampling == 8 ? 3 : upsampling >> 1;
+    const uint32_t size_shift_x = (metadata.tile_size_shift_x < 0 ? 3 : metadata.tile_size_shift_x) + upsampling_shift;
+    const uint32_t size_shift_y = (metadata.tile_size_shift_y < 0 ? 3 : metadata.tile_size_shift_y) + upsampling_shift;
     const uint32_t tile_size_x = 256 << size_shift_x;
     const uint32_t tile_size_y = 256 << size_shift_y;
     const uint32_t tile_width = (width + tile_size_x - 1) >> (8 + size_shift_x);
@@ -346,6 +586,43 @@ int main(int argc, const char *argv[]) {
     if (ret < HYD_ERROR_START)
         goto done;
 
+    ret = hyd_set_target_size(encoder, target_size);
+    if (ret < HYD_ERROR_START)
+        goto done;
+
+    ret = hyd_set_pyramid(encoder, pyramid, write_pyramid_tile, (void *)out_fname);
+    if (ret < HYD_ERROR_START)
+        goto done;
+
+    ret = hyd_set_tile_cache(encoder, tile_cache);
+    if (ret < HYD_ERROR_START)
+        goto done;
+
+    for (int i = 0; i < num_variants; i++) {
+        variants[i] = hyd_encoder_new();
+        variant_buffers[i] = malloc(output_bufsize);
+        if (!variants[i] || !variant_buffers[i]) {
+            fprintf(stderr, "%s: not enough memory\n", argv[0]);
+            goto done;
+        }
+        variant_fouts[i] = fopen(variant_fnames[i], "wb");
+        if (!variant_fouts[i]) {
+            fprintf(stderr, "%s: error opening file for writing: %s\n", argv[0], variant_fnames[i]);
+            goto done;
+        }
+        HYDImageMetadata variant_metadata = metadata;
+        variant_metadata.distance = variant_distances[i];
+        ret = hyd_set_metadata(variants[i], &variant_metadata);
+        if (ret < HYD_ERROR_START)
+            goto done;
+        ret = hyd_set_tile_cache(variants[i], tile_cache);
+        if (ret < HYD_ERROR_START)
+            goto done;
+        ret = hyd_provide_output_buffer(variants[i], variant_buffers[i], output_bufsize);
+        if (ret < HYD_ERROR_START)
+            goto done;
+    }
+
     size_t icc_len = 0;
     if (icc_from_fname && *icc_from_fname) {
         icc_from = fopen(icc_from_fname, "rb");
@@ -395,6 +672,11 @@ int main(int argc, const char *argv[]) {
         HYDStatusCode ret = hyd_set_suggested_icc_profile(encoder, icc_buffer, icc_len);
         if (ret < HYD_ERROR_START)
             goto done;
+        for (int i = 0; i < num_variants; i++) {
+            ret = hyd_set_suggested_icc_profile(variants[i], icc_buffer, icc_len);
+            if (ret < HYD_ERROR_START)
+                goto done;
+        }
         free(icc_buffer);
         icc_buffer = NULL;
     }
@@ -403,6 +685,10 @@ int main(int argc, const char *argv[]) {
     if (ret < HYD_ERROR_START)
         goto done;
 
+    HYDEncoder *encoders[MAX_VARIANTS + 1] = { encoder };
+    for (int i = 0; i < num_variants; i++)
+        encoders[i + 1] = variants[i];
+
     struct spng_row_info row_info = {0};
     for (uint32_t yk = 0; yk < tile_height; yk++) {
         uint32_t y = pfm ? tile_height - yk - 1 : yk;
@@ -446,36 +732,40 @@ int main(int argc, const char *argv[]) {
                 const uint16_t *tile_buffer = ((const uint16_t *)buffer) + x * tile_size_x * 4;
                 const void *const rgb[3] = {tile_buffer, tile_buffer + 1, tile_buffer + 2};
                 // We divide by 2 because spng_stride is in bytes, not in uint16_t units
-                ret = hyd_send_tile(encoder, rgb, x, y, buffer_stride / 2, 4, -1, HYD_UINT16);
+                ret = hyd_send_tile_multi(encoders, num_variants + 1, rgb, x, y, buffer_stride / 2, 4, -1, HYD_UINT16);
             } else if (!pfm) {
                 const uint8_t *tile_buffer = ((const uint8_t *)buffer) + x * tile_size_x * 3;
                 const void *const rgb[3] = {tile_buffer, tile_buffer + 1, tile_buffer + 2};
-                ret = hyd_send_tile(encoder, rgb, x, y, buffer_stride, 3, -1, HYD_UINT8);
+                ret = hyd_send_tile_multi(encoders, num_variants + 1, rgb, x, y, buffer_stride, 3, -1, HYD_UINT8);
             } else {
                 /* pfm goes from bottom to top for some reason */
                 void *buffer_bottom = buffer + buffer_stride * (this_tile_height - 1);
                 const float *tile_buffer = ((const float *)buffer_bottom) + x * tile_size_x * 3;
                 const void *const rgb[3] = {tile_buffer, tile_buffer + 1, tile_buffer + 2};
-                ret = hyd_send_tile(encoder, rgb, x, y, -buffer_stride / 4, 3, y == 0 && x == tile_width - 1,
+                ret = hyd_send_tile_multi(encoders, num_variants + 1, rgb, x, y, -buffer_stride / 4, 3, y == 0 && x == tile_width - 1,
                         HYD_FLOAT32);
             }
             if (ret < HYD_ERROR_START)
                 goto done;
-            do {
-                ret = hyd_flush(encoder);
-                size_t written;
-                HYDStatusCode ret2 = hyd_release_output_buffer(encoder, &written);
-                if (ret2 < HYD_ERROR_START)
-                    goto done;
-                size_t fout_written = fwrite(output_buffer, written, 1, fout);
-                if (written && !fout_written)
-                    goto done;
-                ret2 = hyd_provide_output_buffer(encoder, output_buffer, output_bufsize);
-                if (ret2 < HYD_ERROR_START)
+            for (int i = 0; i <= num_variants; i++) {
+                uint8_t *const out = i ? variant_buffers[i - 1] : output_buffer;
+                FILE *const out_file = i ? variant_fouts[i - 1] : fout;
+                do {
+                    ret = hyd_flush(encoders[i]);
+                    size_t written;
+                    HYDStatusCode ret2 = hyd_release_output_buffer(encoders[i], &written);
+                    if (ret2 < HYD_ERROR_START)
+                        goto done;
+                    size_t fout_written = fwrite(out, written, 1, out_file);
+                    if (written && !fout_written)
+                        goto done;
+                    ret2 = hyd_provide_output_buffer(encoders[i], out, output_bufsize);
+                    if (ret2 < HYD_ERROR_START)
+                        goto done;
+                } while (ret == HYD_NEED_MORE_OUTPUT);
+                if (ret != HYD_OK)
                     goto done;
-            } while (ret == HYD_NEED_MORE_OUTPUT);
-            if (ret != HYD_OK)
-                goto done;
+            }
         }
     }
 
@@ -492,6 +782,16 @@ done:
         error_msg = hyd_error_message_get(encoder);
         hyd_encoder_destroy(encoder);
     }
+    for (int i = 0; i < num_variants; i++) {
+        if (variant_fouts[i])
+            fclose(variant_fouts[i]);
+        if (variants[i]) {
+            if (!error_msg || !*error_msg)
+                error_msg = hyd_error_message_get(variants[i]);
+            hyd_encoder_destroy(variants[i]);
+        }
+        free(variant_buffers[i]);
+    }
     free(buffer);
     free(output_buffer);
     free(icc_buffer);
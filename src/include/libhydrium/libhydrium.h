@@ -152,6 +152,73 @@ typedef struct HYDImageMetadata {
      * but it decodes faster with libjxl.
      */
     int tile_size_shift_y;
+
+    /**
+     * A flag indicating whether to favor decode speed over size when coding
+     * entropy streams. If true, prefix codes are used unless ANS is much
+     * smaller. If false, whichever is estimated to be smaller is used.
+     */
+    int fast_decode;
+
+    /**
+     * Selects built-in entropy codes in place of ones fitted to the image. With 0, codes
+     * are built from the histograms of each frame, which requires buffering its symbols,
+     * except at effort 1, which uses preset 1.
+     * With 1 (trained on photographs) or 2 (trained on graphics and screenshots), symbols
+     * are written as soon as they are computed, at some cost in size.
+     */
+    int entropy_preset;
+
+    /**
+     * How much loss to allow, as a Butteraugli-style distance: larger values give smaller
+     * files at lower fidelity. Valid values are 0.1 to 25. A special value of 0 selects
+     * the default of 1.0, which is intended to be visually close to lossless.
+     */
+    float distance;
+
+    /**
+     * How hard to look for a smaller file. Valid values are 1 to 5, where higher values are
+     * slower. A special value of 0 selects the default of 3. Effort 1 writes built-in entropy
+     * codes and skips chroma-from-luma, effort 2 fits codes to the image but clusters them
+     * coarsely and weighs each quantized coefficient's bits against its error, and effort 3
+     * adds full clustering and adaptive quantization. Effort 4 codes smooth areas with 16x16
+     * transforms where that helps, and effort 5 tries 32x32 ones and searches harder for LZ77
+     * matches.
+     */
+    int effort;
+
+    /**
+     * Codes the image at a lower resolution, for the decoder to upsample. Valid values are
+     * 2, 4, and 8, which divide both dimensions by that factor, and 0 or 1, which code it at
+     * full resolution. Tiles cover that many times more pixels in each direction, so each
+     * tile still codes to as many blocks as it does without upsampling.
+     */
+    int upsampling;
+
+    /**
+     * Splits the HF coefficients of each frame into passes, lowest frequencies first, so a
+     * decoder can show a coarser image from the start of each frame. Valid values are 2 and 3,
+     * and 0 or 1, which codes them all in one pass. The first pass is enough for a quarter of
+     * the resolution, and with 3 passes, the second one is enough for half of it. Passes cost
+     * a little size, and more with an entropy_preset, as those codes are fitted to one pass.
+     */
+    int passes;
+
+    /**
+     * A flag indicating whether to code the LF coefficients in an LF frame of their own, ahead
+     * of the main frame, rather than spread across its LF groups. The LF frame is an 8x smaller
+     * image that decoders can show from the start of the file. This requires one-frame mode,
+     * and it can't be used with upsampling.
+     */
+    int lf_frame;
+
+    /**
+     * A flag indicating whether to embed a preview: the image scaled down by a power of two to
+     * at most 256 pixels on its longer side, which decoders can show before the image itself.
+     * It's gathered from the tiles as they're sent and written ahead of every other frame,
+     * so this requires one-frame mode.
+     */
+    int preview;
 } HYDImageMetadata;
 
 /* opaque structure */
@@ -197,7 +264,8 @@ HYDRIUM_EXPORT HYDStatusCode hyd_provide_output_buffer(HYDEncoder *encoder, uint
  *
  * By default, hydrium encodes one tile at a time, and no tile references any other tile. A tile is 256x256,
  * unless tile_size_shift_x and/or tile_size_shift_y are set to something positive. In that case, the size of a
- * tile will be WxH, where W is (256 << tile_size_shift_x) and H is (256 << tile_size_shift_y).
+ * tile will be WxH, where W is (256 << tile_size_shift_x) and H is (256 << tile_size_shift_y). Both are then
+ * multiplied by the upsampling factor, if one was set.
  *
  * This function accepts an array of three buffers of pixel data, although they may overlap.
  *
@@ -225,7 +293,7 @@ HYDRIUM_EXPORT HYDStatusCode hyd_provide_output_buffer(HYDEncoder *encoder, uint
  * hyd_provide_output_buffer. After you provide another output buffer, do not send the same tile again, instead
  * call hyd_flush to flush the remaining encoded tile to the output buffer.
  *
- * Tiles are always multiples of 256x256, although images are not always a multiple of 256 pixels in each direction.
+ * Tiles are always multiples of 256x256 (times the upsampling factor), although images are not always a multiple of 256 pixels in each direction.
  * If so, the rightmost column and bottom-most row of tiles will be smaller. Make sure you set row_stride correctly
  * for the right-most column, as hydrium will not automatically assume it is smaller than the one provided. Because
  * the image width and height were provided with hyd_set_metadata, hydrium will know how big these tiles should be
@@ -261,6 +329,116 @@ HYDRIUM_EXPORT HYDStatusCode hyd_send_tile(HYDEncoder *encoder, const void *cons
                                            uint32_t tile_x, uint32_t tile_y, ptrdiff_t row_stride,
                                            ptrdiff_t pixel_stride, int is_last, HYDSampleFormat sample_fmt);
 
+/**
+ * @brief Send one tile to several encoders at once, so they can each code it at their own settings.
+ *
+ * This works like calling hyd_send_tile on each encoder in turn, but the tile is only converted to XYB
+ * and transformed by the DCT once, by the first encoder, and only quantized and entropy coded by each of
+ * them. The encoders can differ in distance, target size, effort, entropy preset, and the like, and each
+ * of them writes to its own output buffer, which must be flushed on its own with hyd_flush. They must all
+ * have the same width, height, tiling, linear light flag, and upsampling, or HYD_API_ERROR is returned,
+ * and every tile of the image must be sent to all of them together.
+ *
+ * An error message is set on whichever encoder failed, and the tile may have reached only some of them.
+ * If count is zero, HYD_API_ERROR is returned without an error message, as there is no encoder to set it on.
+ *
+ * @param encoders An array of count HYDEncoder structs.
+ * @param count The number of encoders, at least one.
+ * @return HYD_OK upon success, a negative error code upon failure.
+ *
+ * The rest of the parameters are as in hyd_send_tile.
+ */
+HYDRIUM_EXPORT HYDStatusCode hyd_send_tile_multi(HYDEncoder *const encoders[], size_t count,
+                                                 const void *const buffer[3], uint32_t tile_x, uint32_t tile_y,
+                                                 ptrdiff_t row_stride, ptrdiff_t pixel_stride, int is_last,
+                                                 HYDSampleFormat sample_fmt);
+
+/**
+ * @brief Make the encoded image fit in about target_size bytes, in place of metadata.distance.
+ *
+ * Before the first tile of each frame is encoded, its size is estimated at a range of distances, and
+ * the lowest one whose estimate fits the frame's share of target_size by area is used. In one-frame mode,
+ * only the first tile sent is looked at, as the quantizer is shared by the whole frame. The estimates are
+ * a few percent off either way, so leave some slack if target_size is a hard limit. The preview and the
+ * LF frame, if there are any, count toward it too. This must be called before any tiles are sent.
+ * Pass 0 to turn it off.
+ *
+ * @param encoder A HYDEncoder struct.
+ * @param target_size The size to aim for, in bytes.
+ * @return HYD_OK upon success, a negative error code upon failure.
+ */
+HYDRIUM_EXPORT HYDStatusCode hyd_set_target_size(HYDEncoder *encoder, size_t target_size);
+
+/**
+ * @brief Estimate how many bytes a tile would take, without encoding it or writing any output.
+ *
+ * The tile is passed the same way as to hyd_send_tile, and estimated at the current settings,
+ * not counting the image header, or the preview and LF frame that go ahead of the main frame.
+ * It may be called at any point after hyd_set_metadata, even between tiles, and doesn't change
+ * what gets encoded.
+ *
+ * @param encoder A HYDEncoder struct.
+ * @param buffer An array of three buffers of pixel data.
+ * @param tile_x The X-coordinate, in tiles, of the estimated tile.
+ * @param tile_y The Y-coordinate, in tiles, of the estimated tile.
+ * @param row_stride The line size of the pixel buffer.
+ * @param pixel_stride The inter-pixel stride of the buffer.
+ * @param sample_fmt The sample format of the provided buffer.
+ * @param size Populated by the estimated size, in bytes.
+ * @return HYD_OK upon success, a negative error code upon failure.
+ */
+HYDRIUM_EXPORT HYDStatusCode hyd_estimate_size(HYDEncoder *encoder, const void *const buffer[3],
+                                               uint32_t tile_x, uint32_t tile_y, ptrdiff_t row_stride,
+                                               ptrdiff_t pixel_stride, HYDSampleFormat sample_fmt, size_t *size);
+
+/**
+ * Receives one tile of a lower level of the pyramid, as a complete JPEG XL codestream of its own.
+ * Level 1 is half the size of the image in each direction, level 2 is a quarter of it, and so on.
+ * The data is only valid until the function returns. Returning an error code stops the encode.
+ */
+typedef HYDStatusCode (*HYDPyramidCallback)(void *opaque, int level, uint32_t tile_x, uint32_t tile_y,
+                                            const uint8_t *data, size_t size);
+
+/**
+ * @brief Also encode lower-resolution levels of the image, each as tiles of their own.
+ *
+ * The image itself is encoded as usual. As its tiles are sent, they're also averaged down into levels
+ * that are each half the size of the one before, and once a row of tiles of a level has all of its
+ * pixels, each of those tiles is encoded as an image of its own, with the same settings, and passed to
+ * callback. Levels have the same tile size as the image. Only one row of tiles is kept per level, so
+ * every tile must be sent, a row of tiles at a time, either top to bottom or bottom to top.
+ *
+ * This requires tiled mode, without upsampling, and it must be called before any tiles are sent.
+ * Pass 0 for levels to turn it off. The metadata can't be changed while a pyramid is set.
+ *
+ * @param encoder A HYDEncoder struct.
+ * @param levels The number of lower levels, at most as many as it takes to get down to one pixel.
+ * @param callback The function that receives each tile of the lower levels.
+ * @param opaque A pointer passed to callback as is.
+ * @return HYD_OK upon success, a negative error code upon failure.
+ */
+HYDRIUM_EXPORT HYDStatusCode hyd_set_pyramid(HYDEncoder *encoder, int levels, HYDPyramidCallback callback,
+                                             void *opaque);
+
+/**
+ * @brief Keep the encoded frames of recent tiles, and reuse them for tiles with the same pixels.
+ *
+ * Each tile sent is hashed, along with its size and sample format, and its frame is kept in one of
+ * the given number of slots, picked by the hash, in place of the frame that was there. A later tile
+ * with the same hash and the same pixels gets that frame back, with a frame header of its own, and
+ * skips color conversion, the DCT, and entropy coding, so images with many identical tiles, like
+ * maps, encode much faster. The output is the same as without the cache. Each slot holds one encoded
+ * tile and a copy of its pixels, so memory use grows with the number of slots.
+ *
+ * This requires tiled mode, and it must be called before any tiles are sent. Pass 0 to turn it off.
+ * The metadata can't be changed while a tile cache is set.
+ *
+ * @param encoder A HYDEncoder struct.
+ * @param slots The number of tiles to keep.
+ * @return HYD_OK upon success, a negative error code upon failure.
+ */
+HYDRIUM_EXPORT HYDStatusCode hyd_set_tile_cache(HYDEncoder *encoder, size_t slots);
+
 /**
  * @brief Release the output buffer that was previously provided by hyd_provide_output_buffer.
  *
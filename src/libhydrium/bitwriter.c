@@ -4,6 +4,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "bitwriter.h"
@@ -36,14 +37,86 @@ HYDStatusCode hyd_init_bit_writer(HYDBitWriter *bw, uint8_t *buffer, size_t buff
     memset(bw->overflow, 0, sizeof(bw->overflow));
     bw->overflow_pos = 0;
     bw->realloc_func = &hyd_realloc_func_default;
+    bw->pool = NULL;
+    bw->first_page = NULL;
+    bw->last_page = NULL;
+    bw->page_base = 0;
+    return HYD_OK;
+}
+
+static HYDStatusCode get_page(HYDWriterPagePool *pool, HYDWriterPage **page) {
+    if (pool->free_list) {
+        *page = pool->free_list;
+        pool->free_list = (*page)->next;
+    } else {
+        *page = malloc(sizeof(HYDWriterPage));
+        if (!*page)
+            return HYD_NOMEM;
+    }
+    (*page)->next = NULL;
+    (*page)->len = 0;
+    return HYD_OK;
+}
+
+HYDStatusCode hyd_init_paged_bit_writer(HYDBitWriter *bw, HYDWriterPagePool *pool) {
+    HYDWriterPage *page;
+    HYDStatusCode ret = get_page(pool, &page);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    ret = hyd_init_bit_writer(bw, page->data, sizeof(page->data), 0, 0);
+    bw->realloc_func = NULL;
+    bw->pool = pool;
+    bw->first_page = page;
+    bw->last_page = page;
+    return ret;
+}
+
+void hyd_bitwriter_release(HYDBitWriter *bw) {
+    if (bw->pool) {
+        if (bw->last_page) {
+            bw->last_page->next = bw->pool->free_list;
+            bw->pool->free_list = bw->first_page;
+        }
+        bw->first_page = NULL;
+        bw->last_page = NULL;
+        bw->buffer = NULL;
+    } else {
+        hyd_freep(&bw->buffer);
+    }
+    bw->buffer_len = 0;
+    bw->buffer_pos = 0;
+    bw->page_base = 0;
+}
+
+void hyd_page_pool_free(HYDWriterPagePool *pool) {
+    while (pool->free_list) {
+        HYDWriterPage *page = pool->free_list;
+        pool->free_list = page->next;
+        free(page);
+    }
+}
+
+/* close the current page and continue at the start of a fresh one */
+static HYDStatusCode next_page(HYDBitWriter *bw) {
+    HYDWriterPage *page;
+    HYDStatusCode ret = get_page(bw->pool, &page);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    bw->last_page->len = bw->buffer_pos;
+    bw->last_page->next = page;
+    bw->last_page = page;
+    bw->page_base += bw->buffer_pos;
+    bw->buffer = page->data;
+    bw->buffer_len = sizeof(page->data);
+    bw->buffer_pos = 0;
     return HYD_OK;
 }
 
 static HYDStatusCode regrow_buffer(HYDBitWriter *bw) {
     if (bw->overflow_pos > sizeof(bw->overflow))
         return HYD_INTERNAL_ERROR;
-    if (bw->realloc_func) {
-        bw->overflow_state = bw->realloc_func(&bw->buffer, &bw->buffer_len);
+    if (bw->pool || bw->realloc_func) {
+        bw->overflow_state = bw->pool ? next_page(bw) : bw->realloc_func(&bw->buffer, &bw->buffer_len);
         if (bw->overflow_state < HYD_ERROR_START)
             return bw->overflow_state;
         memcpy(bw->buffer + bw->buffer_pos, bw->overflow, bw->overflow_pos);
@@ -56,7 +129,7 @@ static HYDStatusCode regrow_buffer(HYDBitWriter *bw) {
     return bw->overflow_state;
 }
 
-static HYDStatusCode drain_cache(HYDBitWriter *bw) {
+static HYDStatusCode drain_cache_slow(HYDBitWriter *bw) {
     while (bw->cache_bits >= 8) {
         uint8_t *buf = bw->buffer_pos >= bw->buffer_len ?
                        bw->overflow + bw->overflow_pos++ :
@@ -72,55 +145,201 @@ static HYDStatusCode drain_cache(HYDBitWriter *bw) {
     return bw->overflow_state;
 }
 
-static inline uint32_t rl32(const uint8_t *const b) {
+static HYDStatusCode drain_cache(HYDBitWriter *bw) {
+    /* whole-word store when there's room, and bytes only near the end of the buffer */
+    if (bw->buffer_len - bw->buffer_pos < 8 || bw->overflow_pos)
+        return drain_cache_slow(bw);
+    hyd_write_cache_word(bw);
+    return bw->overflow_state;
+}
+
+static inline uint64_t rl64(const uint8_t *const b) {
     /* most compilers will change this to an instruction on platforms where there is one */
-    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    return (uint64_t)b[0] | ((uint64_t)b[1] << 8) | ((uint64_t)b[2] << 16) | ((uint64_t)b[3] << 24) |
+        ((uint64_t)b[4] << 32) | ((uint64_t)b[5] << 40) | ((uint64_t)b[6] << 48) | ((uint64_t)b[7] << 56);
 }
 
-HYDStatusCode hyd_write_drain_to(HYDBitWriter *to, HYDBitWriter *from) {
-    drain_cache(to);
-    drain_cache(from);
+/*
+ * Append as much of buf as the writer takes, and set *written to how much that was.
+ * That's all of it unless the writer runs out of room and can't grow.
+ */
+static HYDStatusCode write_bytes(HYDBitWriter *to, const uint8_t *buf, size_t len, size_t *written) {
+    *written = 0;
+    HYDStatusCode ret = drain_cache(to);
+    if (ret < HYD_ERROR_START)
+        return ret;
     if (!to->cache_bits) {
-        size_t len = from->buffer_pos;
         size_t pos = 0;
         while (len) {
             size_t remaining = to->buffer_len - to->buffer_pos;
             size_t to_copy = hyd_min(remaining, len);
-            memcpy(to->buffer + to->buffer_pos, from->buffer + pos, to_copy);
+            memcpy(to->buffer + to->buffer_pos, buf + pos, to_copy);
             pos += to_copy;
             len -= to_copy;
             to->buffer_pos += to_copy;
+            *written = pos;
             if (len) {
-                HYDStatusCode ret = regrow_buffer(to);
+                ret = regrow_buffer(to);
                 if (ret != HYD_OK)
-                    break;
+                    return ret;
             }
         }
     } else {
+        /*
+         * to holds 1-7 pending bits, so each source word is shifted up
+         * past them and the bits it pushes out carry into the next word
+         */
+        const int shift = to->cache_bits;
         size_t p = 0;
-        for (; p + 4 < from->buffer_pos; p += 4)
-            hyd_write(to, rl32(from->buffer + p), 32);
-        for (; p < from->buffer_pos; p++)
-            hyd_write(to, from->buffer[p], 8);
+        while (len - p >= 8) {
+            if (to->buffer_len - to->buffer_pos < 8) {
+                ret = regrow_buffer(to);
+                if (ret != HYD_OK) {
+                    *written = p;
+                    return ret;
+                }
+            }
+            const size_t words = hyd_min(len - p, to->buffer_len - to->buffer_pos) >> 3;
+            uint64_t cache = to->cache;
+            uint8_t *out = to->buffer + to->buffer_pos;
+            for (size_t w = 0; w < words; w++, p += 8, out += 8) {
+                const uint64_t word = rl64(buf + p);
+                hyd_wl64(out, cache | (word << shift));
+                cache = word >> (64 - shift);
+            }
+            to->cache = cache;
+            to->buffer_pos += words << 3;
+        }
+        /* a byte that made it into the cache is written, even if the cache couldn't drain */
+        for (; p < len && to->overflow_state == HYD_OK; p++)
+            hyd_write(to, buf[p], 8);
+        *written = p;
+    }
+    return to->overflow_state;
+}
+
+HYDStatusCode hyd_write_bytes(HYDBitWriter *to, const uint8_t *buf, size_t len) {
+    size_t written;
+    return write_bytes(to, buf, len, &written);
+}
+
+/* drop the first count bytes of a flushed writer, so what's left can be drained again later */
+static void skip_bytes(HYDBitWriter *bw, size_t count) {
+    if (!bw->pool) {
+        memmove(bw->buffer, bw->buffer + count, bw->buffer_pos - count);
+        bw->buffer_pos -= count;
+        return;
+    }
+    while (bw->first_page != bw->last_page && count >= bw->first_page->len) {
+        HYDWriterPage *page = bw->first_page;
+        count -= page->len;
+        bw->page_base -= page->len;
+        bw->first_page = page->next;
+        page->next = bw->pool->free_list;
+        bw->pool->free_list = page;
+    }
+    HYDWriterPage *page = bw->first_page;
+    if (page == bw->last_page) {
+        memmove(page->data, page->data + count, bw->buffer_pos - count);
+        bw->buffer_pos -= count;
+    } else {
+        memmove(page->data, page->data + count, page->len - count);
+        page->len -= count;
+        bw->page_base -= count;
+    }
+}
+
+HYDStatusCode hyd_write_drain_to(HYDBitWriter *to, HYDBitWriter *from) {
+    HYDStatusCode ret = HYD_OK;
+    drain_cache(to);
+    drain_cache(from);
+    if (to->pool && to->pool == from->pool && !to->cache_bits && !to->overflow_pos && !from->overflow_pos) {
+        /* byte-aligned and from the same pool, so hand the pages over instead of copying them */
+        to->last_page->len = to->buffer_pos;
+        to->last_page->next = from->first_page;
+        to->last_page = from->last_page;
+        to->page_base += to->buffer_pos + from->page_base;
+        to->buffer = from->buffer;
+        to->buffer_len = from->buffer_len;
+        to->buffer_pos = from->buffer_pos;
+        from->first_page = NULL;
+        from->last_page = NULL;
+        from->buffer = NULL;
+        from->buffer_len = 0;
+        from->buffer_pos = 0;
+        from->page_base = 0;
+    } else {
+        size_t done = 0, written;
+        if (from->pool) {
+            for (const HYDWriterPage *page = from->first_page; page && ret == HYD_OK; page = page->next) {
+                ret = write_bytes(to, page->data, page == from->last_page ? from->buffer_pos : page->len, &written);
+                done += written;
+            }
+        } else {
+            ret = write_bytes(to, from->buffer, from->buffer_pos, &written);
+            done = written;
+        }
+        /* to couldn't take it all, so the rest stays in from for another try once to has room */
+        if (ret != HYD_OK) {
+            skip_bytes(from, done);
+            return ret;
+        }
     }
     hyd_write(to, from->cache, from->cache_bits);
     return to->overflow_state;
 }
 
+void hyd_bitwriter_copy(const HYDBitWriter *bw, uint8_t *out) {
+    for (const HYDWriterPage *page = bw->first_page; page; page = page->next) {
+        const size_t len = page == bw->last_page ? bw->buffer_pos : page->len;
+        memcpy(out, page->data, len);
+        out += len;
+    }
+}
+
+HYDStatusCode hyd_bitwriter_take(HYDBitWriter *from, size_t *pos, HYDBitWriter *to) {
+    while (from->first_page) {
+        HYDWriterPage *page = from->first_page;
+        const size_t len = page == from->last_page ? from->buffer_pos : page->len;
+        const size_t count = hyd_min(len - *pos, to->buffer_len - to->buffer_pos);
+        memcpy(to->buffer + to->buffer_pos, page->data + *pos, count);
+        to->buffer_pos += count;
+        *pos += count;
+        if (*pos < len)
+            return HYD_NEED_MORE_OUTPUT;
+        /* the last page stays put, as it's still the one being written to */
+        if (page == from->last_page)
+            break;
+        from->first_page = page->next;
+        page->next = from->pool->free_list;
+        from->pool->free_list = page;
+        *pos = 0;
+    }
+    return HYD_OK;
+}
+
 HYDStatusCode hyd_write(HYDBitWriter *bw, uint64_t value, int bits) {
     if (bits <= 0)
         return bw->overflow_state;
     if (bits > 56)
         return HYD_API_ERROR;
-    if (bits <= 64 - bw->cache_bits) {
-        bw->cache |= (value & ~(~UINT64_C(0) << bits)) << bw->cache_bits;
-        bw->cache_bits += bits;
-        return bw->overflow_state;
+    if (bits > 64 - bw->cache_bits) {
+        HYDStatusCode ret = drain_cache(bw);
+        if (ret < HYD_ERROR_START)
+            return ret;
     }
-    HYDStatusCode ret = drain_cache(bw);
-    if (ret < HYD_ERROR_START)
-        return ret;
-    return hyd_write(bw, value, bits);
+    bw->cache |= (value & ~(~UINT64_C(0) << bits)) << bw->cache_bits;
+    bw->cache_bits += bits;
+    return bw->overflow_state;
+}
+
+HYDStatusCode hyd_write_reserve(HYDBitWriter *bw, size_t bits) {
+    if (bw->overflow_state)
+        return bw->overflow_state;
+    /* room for the bits and for the whole-word store past them */
+    if (bw->overflow_pos || bw->buffer_len - bw->buffer_pos < ((bw->cache_bits + bits + 7) >> 3) + 8)
+        return HYD_NEED_MORE_OUTPUT;
+    return HYD_OK;
 }
 
 HYDStatusCode hyd_write_zero_pad(HYDBitWriter *bw) {
@@ -6,6 +6,19 @@
 
 #include "libhydrium/libhydrium.h"
 
+#define HYD_WRITER_PAGE_SIZE 8192
+
+typedef struct HYDWriterPage {
+    struct HYDWriterPage *next;
+    size_t len;
+    uint8_t data[HYD_WRITER_PAGE_SIZE];
+} HYDWriterPage;
+
+/* pages that have been drained to output and can be handed out again */
+typedef struct HYDWriterPagePool {
+    HYDWriterPage *free_list;
+} HYDWriterPagePool;
+
 typedef struct HYDBitWriter {
     uint8_t *buffer;
     size_t buffer_pos;
@@ -16,6 +29,12 @@ typedef struct HYDBitWriter {
     size_t overflow_pos;
     int overflow_state;
     HYDStatusCode (*realloc_func)(uint8_t **buffer, size_t *buffer_len);
+
+    // paged only
+    HYDWriterPagePool *pool;
+    HYDWriterPage *first_page;
+    HYDWriterPage *last_page;
+    size_t page_base;
 } HYDBitWriter;
 
 typedef struct U32Table {
@@ -23,16 +42,90 @@ typedef struct U32Table {
     const uint32_t upos[4];
 } U32Table;
 
+static inline void hyd_wl64(uint8_t *b, const uint64_t v) {
+    /* most compilers will change this to a single store on platforms where there is one */
+    b[0] = v; b[1] = v >> 8; b[2] = v >> 16; b[3] = v >> 24;
+    b[4] = v >> 32; b[5] = v >> 40; b[6] = v >> 48; b[7] = v >> 56;
+}
+
+/*
+ * Store the whole cache as one word and keep only the partial byte.
+ * Requires 8 bytes of room at buffer_pos.
+ */
+static inline void hyd_write_cache_word(HYDBitWriter *bw) {
+    const int bytes = bw->cache_bits >> 3;
+    hyd_wl64(bw->buffer + bw->buffer_pos, bw->cache);
+    bw->buffer_pos += bytes;
+    bw->cache = bytes < 8 ? bw->cache >> (bytes << 3) : 0;
+    bw->cache_bits &= 7;
+}
+
 HYDStatusCode hyd_init_bit_writer(HYDBitWriter *bw, uint8_t *buffer, size_t buffer_len, uint64_t cache, int cache_bits);
 HYDStatusCode hyd_write(HYDBitWriter *bw, uint64_t value, int bits);
 
+/**
+ * @brief Initialize a writer that grows by chaining pages taken from pool rather than by realloc.
+ * Pages from writers sharing a pool are spliced, not copied, by hyd_write_drain_to.
+ * @return HYD_OK upon success, negative upon error.
+ */
+HYDStatusCode hyd_init_paged_bit_writer(HYDBitWriter *bw, HYDWriterPagePool *pool);
+
+/*
+ * Hand the writer's storage back: pages go to the pool, a flat buffer is freed.
+ * Safe to call on a zeroed writer.
+ */
+void hyd_bitwriter_release(HYDBitWriter *bw);
+void hyd_page_pool_free(HYDWriterPagePool *pool);
+
+/**
+ * @brief Copy bytes out of a flushed paged writer into the flat buffer of to,
+ * recycling each page once it has been copied out. pos is the offset into the first page.
+ * @return HYD_OK once everything was copied, HYD_NEED_MORE_OUTPUT if to ran out of room.
+ */
+HYDStatusCode hyd_bitwriter_take(HYDBitWriter *from, size_t *pos, HYDBitWriter *to);
+
+/**
+ * @brief Copy every byte of a flushed paged writer into out, which must have room for
+ * hyd_bitwriter_tell(bw) of them. The writer is left as it is.
+ */
+void hyd_bitwriter_copy(const HYDBitWriter *bw, uint8_t *out);
+
+/* number of whole bytes written so far */
+static inline size_t hyd_bitwriter_tell(const HYDBitWriter *bw) {
+    return bw->page_base + bw->buffer_pos;
+}
+
+/**
+ * @brief Check whether the next `bits` bits can be written with hyd_write_fast.
+ * The buffer is not grown here; that's left to the slow path of hyd_write.
+ * @return HYD_OK if they can, HYD_NEED_MORE_OUTPUT if they can't.
+ */
+HYDStatusCode hyd_write_reserve(HYDBitWriter *bw, size_t bits);
+
+/*
+ * Unchecked hyd_write: value must fit in bits, bits must be at most 56,
+ * and the bits must have been reserved with hyd_write_reserve.
+ */
+static inline void hyd_write_fast(HYDBitWriter *bw, uint64_t value, int bits) {
+    if (bits >= 64 - bw->cache_bits)
+        hyd_write_cache_word(bw);
+    bw->cache |= value << bw->cache_bits;
+    bw->cache_bits += bits;
+}
+
 HYDStatusCode hyd_write_zero_pad(HYDBitWriter *bw);
 HYDStatusCode hyd_write_u32(HYDBitWriter *bw, const U32Table *table, uint32_t value);
 HYDStatusCode hyd_write_enum(HYDBitWriter *bw, uint32_t value);
 HYDStatusCode hyd_write_u64(HYDBitWriter *bw, uint64_t value);
 HYDStatusCode hyd_write_bool(HYDBitWriter *bw, int flag);
 HYDStatusCode hyd_bitwriter_flush(HYDBitWriter *bw);
+/*
+ * Append everything in from to to. If to can't grow and runs out of room, its overflow_state is
+ * set and the bytes it didn't take are left at the start of from, so draining again resumes there.
+ */
 HYDStatusCode hyd_write_drain_to(HYDBitWriter *to, HYDBitWriter *from);
+/* append len whole bytes from buf to the writer, whatever its bit alignment */
+HYDStatusCode hyd_write_bytes(HYDBitWriter *to, const uint8_t *buf, size_t len);
 HYDStatusCode hyd_write_icc_varint(HYDBitWriter *bw, uint64_t value);
 HYDStatusCode hyd_realloc_func_default(uint8_t **buffer, size_t *buffer_size);
 
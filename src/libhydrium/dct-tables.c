@@ -0,0 +1,411 @@
+/*
+ * libhydrium dct-tables.c
+ *
+ * Quantization weights of the larger square DCTs, from the default dequantization matrices.
+ */
+#include "dct-tables.h"
+
+const float hyd_dct16_weights[3][256] = {
+    {
+        5623.05, 4442.79, 4442.79, 4029.72, 3510.26, 3510.26, 2773.47, 3320.36, 3320.36, 2773.47,
+        2319.08, 2669.44, 2887.87, 2669.44, 2319.08, 2070.05, 2286.87, 2425.35, 2425.35, 2286.87,
+        2070.05, 1847.77, 2046.9, 2197.98, 2256.03, 2197.98, 2046.9, 1847.77, 1649.35, 1830.48,
+        1981.43, 2070.05, 2070.05, 1981.43, 1830.48, 1649.35, 1486.86, 1636.09, 1780.88, 1883.59,
+        1921.22, 1883.59, 1780.88, 1636.09, 1486.86, 1341.39, 1477.36, 1601.25, 1704.94, 1765.06,
+        1765.06, 1704.94, 1601.25, 1477.36, 1341.39, 1210.16, 1333.77, 1449.64, 1546.86, 1612.67,
+        1636.09, 1612.67, 1546.86, 1449.64, 1333.77, 1210.16, 1076.37, 1203.96, 1311.41, 1405.87,
+        1477.36, 1516.2, 1516.2, 1477.36, 1405.87, 1311.41, 1203.96, 1076.37, 936.629, 1069.6,
+        1185.73, 1275.82, 1349.11, 1397.46, 1414.4, 1397.46, 1349.11, 1275.82, 1185.73, 1069.6,
+        936.629, 815.032, 931.227, 1049.71, 1156.52, 1229.14, 1282.78, 1311.41, 1311.41, 1282.78,
+        1229.14, 1156.52, 1049.71, 931.227, 815.032, 709.222, 810.691, 915.316, 1017.88, 1111.3,
+        1173.88, 1210.16, 1222.75, 1210.16, 1173.88, 1111.3, 1017.88, 915.316, 810.691, 709.222,
+        594.926, 705.713, 797.881, 889.741, 975.891, 1049.71, 1104.16, 1133.17, 1133.17, 1104.16,
+        1049.71, 975.891, 889.741, 797.881, 705.713, 594.926, 591.336, 695.342, 777.214, 855.788,
+        925.875, 981.716, 1017.88, 1030.42, 1017.88, 981.716, 925.875, 855.788, 777.214, 695.342,
+        591.336, 580.74, 673.483, 749.636, 815.032, 870.085, 910.108, 931.227, 931.227, 910.108,
+        870.085, 815.032, 749.636, 673.483, 580.74, 563.648, 644.447, 716.32, 769.178, 810.691,
+        837.29, 846.46, 837.29, 810.691, 769.178, 716.32, 644.447, 563.648, 540.848, 609.59,
+        673.483, 719.909, 749.636, 765.208, 765.208, 749.636, 719.909, 673.483, 609.59, 540.848,
+        513.331, 570.402, 620.915, 660.822, 686.482, 695.342, 686.482, 660.822, 620.915, 570.402,
+        513.331, 482.201, 528.378, 567.011, 594.926, 609.59, 609.59, 594.926, 567.011, 528.378,
+        482.201, 448.586, 484.924, 513.331, 531.459, 537.694, 531.459, 513.331, 484.924, 448.586,
+        413.568, 441.276, 461.133, 471.509, 471.509, 461.133, 441.276, 413.568, 378.123, 398.464,
+        411.365, 415.788, 411.365, 398.464, 378.123, 332.417, 353.23, 364.226, 364.226, 353.23,
+        332.417, 284.416, 297.228, 301.652, 297.228, 284.416, 241.042, 247.985, 247.985, 241.042,
+        202.525, 205.323, 202.525, 168.835, 168.835, 139.755,
+    },
+    {
+        1595.74, 1379.29, 1379.29, 1298.48, 1192.21, 1192.21, 1030.49, 1151.88, 1151.88, 1030.49,
+        881.805, 1006.4, 1056.59, 1006.4, 881.805, 745.869, 863.816, 942.004, 942.004, 863.816,
+        745.869, 630.889, 733.606, 814.786, 846.701, 814.786, 733.606, 630.889, 533.633, 622.207,
+        699.29, 745.869, 745.869, 699.29, 622.207, 533.633, 478.339, 527.322, 597.523, 648.999,
+        668.194, 648.999, 597.523, 527.322, 478.339, 430.682, 475.224, 515.879, 560.35, 589.714,
+        589.714, 560.35, 515.879, 475.224, 430.682, 387.773, 428.186, 466.137, 498.022, 519.628,
+        527.322, 519.628, 498.022, 466.137, 428.186, 387.773, 351.656, 385.749, 420.872, 451.794,
+        475.224, 487.96, 487.96, 475.224, 451.794, 420.872, 385.749, 351.656, 322.455, 350.276,
+        379.797, 409.23, 433.208, 449.037, 454.587, 449.037, 433.208, 409.23, 379.797, 350.276,
+        322.455, 295.679, 321.295, 346.202, 370.262, 393.973, 411.506, 420.872, 420.872, 411.506,
+        393.973, 370.262, 346.202, 321.295, 295.679, 271.126, 294.696, 317.861, 339.62, 358.728,
+        375.927, 387.773, 391.885, 387.773, 375.927, 358.728, 339.62, 317.861, 294.696, 271.126,
+        250.673, 270.289, 291.785, 312.295, 330.817, 346.202, 357.29, 363.114, 363.114, 357.29,
+        346.202, 330.817, 312.295, 291.785, 270.289, 250.673, 250.03, 267.806, 287.05, 304.812,
+        320.142, 332.046, 339.62, 342.222, 339.62, 332.046, 320.142, 304.812, 287.05, 267.806,
+        250.03, 248.121, 264.205, 280.657, 295.679, 307.976, 316.733, 321.295, 321.295, 316.733,
+        307.976, 295.679, 280.657, 264.205, 248.121, 244.999, 259.315, 272.815, 285.196, 294.696,
+        300.688, 302.736, 300.688, 294.696, 285.196, 272.815, 259.315, 244.999, 240.748, 253.273,
+        264.205, 273.666, 280.657, 284.277, 284.277, 280.657, 273.666, 264.205, 253.273, 240.748,
+        235.477, 246.239, 255.258, 262.088, 266.354, 267.806, 266.354, 262.088, 255.258, 246.239,
+        235.477, 229.314, 238.379, 245.617, 250.673, 253.273, 253.273, 250.673, 245.617, 238.379,
+        229.314, 222.396, 229.862, 235.477, 238.967, 240.151, 238.967, 235.477, 229.862, 222.396,
+        214.864, 220.853, 225.012, 227.145, 227.145, 225.012, 220.853, 214.864, 206.856, 211.502,
+        214.378, 215.352, 214.378, 211.502, 206.856, 197.584, 201.608, 203.67, 203.67, 201.608,
+        197.584, 187.614, 190.379, 191.315, 190.379, 187.614, 177.586, 179.268, 179.268, 177.586,
+        167.612, 168.377, 167.612, 157.787, 157.787, 148.189,
+    },
+    {
+        578.752, 422.071, 422.071, 370.334, 307.807, 307.807, 224.477, 285.701, 285.701, 224.477,
+        168.965, 213.266, 236.971, 213.266, 168.965, 131.904, 163.892, 186.301, 186.301, 163.892,
+        131.904, 102.972, 128.709, 150.322, 159.112, 150.322, 128.709, 102.972, 80.3854, 100.883,
+        119.905, 131.904, 131.904, 119.905, 100.883, 80.3854, 70.9164, 78.9832, 95.0199, 107.373,
+        112.103, 107.373, 95.0199, 78.9832, 70.9164, 63.1508, 70.4062, 77.0913, 86.4086, 93.1892,
+        93.1892, 86.4086, 77.0913, 70.4062, 63.1508, 56.2356, 62.7465, 68.92, 74.1479, 77.7108,
+        78.9832, 77.7108, 74.1479, 68.92, 62.7465, 56.2356, 50.3817, 55.9113, 61.5632, 66.5804,
+        70.4062, 72.4943, 72.4943, 70.4062, 66.5804, 61.5632, 55.9113, 50.3817, 45.5604, 50.1523,
+        54.9587, 59.6841, 63.5603, 66.1316, 67.0354, 66.1316, 63.5603, 59.6841, 54.9587, 50.1523,
+        45.5604, 41.2005, 45.3702, 49.476, 53.436, 57.2301, 60.051, 61.5632, 61.5632, 60.051,
+        57.2301, 53.436, 49.476, 45.3702, 41.2005, 37.2578, 41.0416, 44.8081, 48.3863, 51.5592,
+        54.3402, 56.2356, 56.8949, 56.2356, 54.3402, 51.5592, 48.3863, 44.8081, 41.0416, 37.2578,
+        29.4481, 37.1244, 40.5715, 43.8989, 46.934, 49.476, 51.3195, 52.2914, 52.2914, 51.3195,
+        49.476, 46.934, 43.8989, 40.5715, 37.1244, 29.4481, 29.1967, 36.7289, 39.8086, 42.6807,
+        45.1814, 47.1365, 48.3863, 48.8167, 48.3863, 47.1365, 45.1814, 42.6807, 39.8086, 36.7289,
+        29.1967, 28.4584, 35.1041, 38.7817, 41.2005, 43.1952, 44.6236, 45.3702, 45.3702, 44.6236,
+        43.1952, 41.2005, 38.7817, 35.1041, 28.4584, 27.2792, 32.9797, 37.5271, 39.5104, 41.0416,
+        42.0113, 42.3436, 42.0113, 41.0416, 39.5104, 37.5271, 32.9797, 27.2792, 25.7294, 30.4816,
+        35.1041, 37.6631, 38.7817, 39.3628, 39.3628, 38.7817, 37.6631, 35.1041, 30.4816, 25.7294,
+        23.8949, 27.7434, 31.2868, 34.173, 36.0678, 36.7289, 36.0678, 34.173, 31.2868, 27.7434,
+        23.8949, 21.8684, 24.8931, 27.5101, 29.4481, 30.4816, 30.4816, 29.4481, 27.5101, 24.8931,
+        21.8684, 19.7407, 22.0436, 23.8949, 25.0989, 25.517, 25.0989, 23.8949, 22.0436, 19.7407,
+        17.5938, 19.2865, 20.5273, 21.1847, 21.1847, 20.5273, 19.2865, 17.5938, 15.4965, 16.6905,
+        17.4612, 17.7277, 17.4612, 16.6905, 15.4965, 12.3903, 13.863, 14.6716, 14.6716, 13.863,
+        12.3903, 9.2861, 10.0745, 10.3535, 10.0745, 9.2861, 6.8382, 7.20692, 7.20692, 6.8382,
+        4.95577, 5.08313, 4.95577, 3.5399, 3.5399, 2.49561,
+    },
+};
+
+const float hyd_dct32_weights[3][1024] = {
+    {
+        9824.01, 8777.32, 7842.15, 7006.62, 8777.32, 8377.14, 7636.34, 6879.69, 7842.15, 7636.34,
+        7143.37, 6544.57, 7006.62, 6879.69, 6544.57, 6091.31, 6260.11, 6260.11, 5593.14, 6173.89,
+        6173.89, 5593.14, 4997.22, 5531.09, 5935.84, 5935.84, 5531.09, 4997.22, 4476.63, 4950.85,
+        5355.63, 5593.14, 5593.14, 5355.63, 4950.85, 4476.63, 4014.05, 4442.06, 4818.87, 5093.31,
+        5194.19, 5093.31, 4818.87, 4442.06, 4014.05, 3599.27, 3986.88, 4341.93, 4621.39, 4777.75,
+        4777.75, 4621.39, 4341.93, 3986.88, 3599.27, 3227.35, 3577.59, 3907.69, 4185.84, 4374.73,
+        4442.06, 4374.73, 4185.84, 3907.69, 3577.59, 3227.35, 2893.86, 3209.84, 3514.11, 3782.81,
+        3986.88, 4097.99, 4097.99, 3986.88, 3782.81, 3514.11, 3209.84, 2893.86, 2594.83, 2879.58,
+        3158.39, 3413.14, 3621.21, 3758.82, 3807.11, 3758.82, 3621.21, 3413.14, 3158.39, 2879.58,
+        2594.83, 2333.87, 2583.09, 2837.5, 3076.02, 3280.99, 3432.87, 3514.11, 3514.11, 3432.87,
+        3280.99, 3076.02, 2837.5, 2583.09, 2333.87, 2106.32, 2324.69, 2548.41, 2769.79, 2967.27,
+        3124.95, 3227.35, 3262.92, 3227.35, 3124.95, 2967.27, 2769.79, 2548.41, 2324.69, 2106.32,
+        1900.96, 2098.63, 2297.53, 2492.39, 2679.77, 2837.5, 2952.31, 3012.99, 3012.99, 2952.31,
+        2837.5, 2679.77, 2492.39, 2297.53, 2098.63, 1900.96, 1715.61, 1894.47, 2075.83, 2253.48,
+        2419.41, 2571.44, 2692.31, 2769.79, 2796.52, 2769.79, 2692.31, 2571.44, 2419.41, 2253.48,
+        2075.83, 1894.47, 1715.61, 1548.34, 1710.13, 1875.24, 2038.75, 2194.22, 2333.87, 2449.16,
+        2537.03, 2583.09, 2583.09, 2537.03, 2449.16, 2333.87, 2194.22, 2038.75, 1875.24, 1710.13,
+        1548.34, 1397.38, 1543.68, 1693.84, 1843.9, 1988.68, 2121.85, 2236.27, 2324.69, 2380.72,
+        2399.93, 2380.72, 2324.69, 2236.27, 2121.85, 1988.68, 1843.9, 1693.84, 1543.68, 1397.38,
+        1274.22, 1393.41, 1529.83, 1667.24, 1801.44, 1927.25, 2038.75, 2129.69, 2194.22, 2227.75,
+        2227.75, 2194.22, 2129.69, 2038.75, 1927.25, 1801.44, 1667.24, 1529.83, 1393.41, 1274.22,
+        1207.57, 1272.42, 1381.59, 1507.18, 1631.1, 1749.13, 1856.33, 1947.37, 2017.04, 2060.86,
+        2075.83, 2060.86, 2017.04, 1947.37, 1856.33, 1749.13, 1631.1, 1507.18, 1381.59, 1272.42,
+        1207.57, 1144.4, 1205.95, 1267.05, 1362.24, 1476.33, 1586.44, 1688.47, 1777.88, 1850.1,
+        1900.96, 1927.25, 1927.25, 1900.96, 1850.1, 1777.88, 1688.47, 1586.44, 1476.33, 1362.24,
+        1267.05, 1205.95, 1144.4, 1084.54, 1142.94, 1201.11, 1258.21, 1335.84, 1438.1, 1534.43,
+        1621.01, 1693.84, 1749.13, 1783.72, 1795.5, 1783.72, 1749.13, 1693.84, 1621.01, 1534.43,
+        1438.1, 1335.84, 1258.21, 1201.11, 1142.94, 1084.54, 1027.82, 1083.22, 1138.58, 1193.14,
+        1246.02, 1303.02, 1393.41, 1476.33, 1548.34, 1606.05, 1646.44, 1667.24, 1667.24, 1646.44,
+        1606.05, 1548.34, 1476.33, 1393.41, 1303.02, 1246.02, 1193.14, 1138.58, 1083.22, 1027.82,
+        974.055, 1026.62, 1079.27, 1131.37, 1182.14, 1230.7, 1276.02, 1343.3, 1413.45, 1472.01,
+        1516.18, 1543.68, 1553.03, 1543.68, 1516.18, 1472.01, 1413.45, 1343.3, 1276.02, 1230.7,
+        1182.14, 1131.37, 1079.27, 1026.62, 974.055, 923.105, 972.965, 1023.03, 1072.75, 1121.43,
+        1168.29, 1212.45, 1252.96, 1288.83, 1347.06, 1393.41, 1425.69, 1442.27, 1442.27, 1425.69,
+        1393.41, 1347.06, 1288.83, 1252.96, 1212.45, 1168.29, 1121.43, 1072.75, 1023.03, 972.965,
+        923.105, 866.767, 922.114, 969.711, 1017.11, 1063.73, 1108.88, 1151.77, 1191.56, 1227.34,
+        1258.21, 1283.29, 1313.82, 1335.84, 1343.3, 1335.84, 1313.82, 1283.29, 1258.21, 1227.34,
+        1191.56, 1151.77, 1108.88, 1063.73, 1017.11, 969.711, 922.114, 866.767, 813.455, 865.71,
+        918.901, 964.33, 1008.93, 1052.34, 1093.89, 1132.81, 1168.29, 1199.51, 1225.67, 1246.02,
+        1259.97, 1267.05, 1267.05, 1259.97, 1246.02, 1225.67, 1199.51, 1168.29, 1132.81, 1093.89,
+        1052.34, 1008.93, 964.33, 918.901, 865.71, 813.455, 763.423, 812.5, 862.551, 913.116,
+        956.884, 998.576, 1038.72, 1076.65, 1111.64, 1142.94, 1169.81, 1191.56, 1207.57, 1217.38,
+        1220.68, 1217.38, 1207.57, 1191.56, 1169.81, 1142.94, 1111.64, 1076.65, 1038.72, 998.576,
+        956.884, 913.116, 862.551, 812.5, 763.423, 716.468, 762.559, 809.645, 857.327, 905.116,
+        947.459, 986.18, 1023.03, 1057.38, 1088.53, 1115.82, 1138.58, 1156.23, 1168.29, 1174.41,
+        1174.41, 1168.29, 1156.23, 1138.58, 1115.82, 1088.53, 1057.38, 1023.03, 986.18, 947.459,
+        905.116, 857.327, 809.645, 762.559, 716.468, 672.401, 715.685, 759.974, 804.921, 850.098,
+        894.997, 936.158, 971.878, 1005.46, 1036.28, 1063.73, 1087.2, 1106.12, 1120.02, 1128.51,
+        1131.37, 1128.51, 1120.02, 1106.12, 1087.2, 1063.73, 1036.28, 1005.46, 971.878, 936.158,
+        894.997, 850.098, 804.921, 759.974, 715.685, 672.401, 631.045, 671.691, 713.342, 755.696,
+        798.38, 840.947, 882.875, 923.105, 955.828, 986.18, 1013.59, 1037.5, 1057.38, 1072.75,
+        1083.22, 1088.53, 1088.53, 1083.22, 1072.75, 1057.38, 1037.5, 1013.59, 986.18, 955.828,
+        923.105, 882.875, 840.947, 798.38, 755.696, 713.342, 671.691, 631.045, 630.399, 669.565,
+        709.464, 749.771, 790.093, 829.973, 868.887, 906.252, 938.195, 965.402, 989.533, 1010.09,
+        1026.62, 1038.72, 1046.11, 1048.6, 1046.11, 1038.72, 1026.62, 1010.09, 989.533, 965.402,
+        938.195, 906.252, 868.887, 829.973, 790.093, 749.771, 709.464, 669.565, 630.399, 628.468,
+        666.045, 704.089, 742.258, 780.147, 817.295, 853.184, 887.252, 918.901, 943.322, 964.33,
+        981.74, 995.168, 1004.3, 1008.93, 1008.93, 1004.3, 995.168, 981.74, 964.33, 943.322,
+        918.901, 887.252, 853.184, 817.295, 780.147, 742.258, 704.089, 666.045, 628.468, 625.27,
+        661.164, 697.27, 733.233, 768.643, 803.043, 835.93, 866.767, 894.997, 920.065, 938.195,
+        952.674, 963.26, 969.711, 971.878, 969.711, 963.26, 952.674, 938.195, 920.065, 894.997,
+        866.767, 835.93, 803.043, 768.643, 733.233, 697.27, 661.164, 625.27, 620.833, 654.969,
+        689.072, 722.784, 755.696, 787.361, 817.295, 844.995, 869.95, 891.664, 909.674, 923.105,
+        931.1, 935.143, 935.143, 931.1, 923.105, 909.674, 891.664, 869.95, 844.995, 817.295,
+        787.361, 755.696, 722.784, 689.072, 654.969, 620.833, 615.588, 647.515, 679.573, 711.012,
+        741.43, 770.396, 797.453, 822.134, 843.98, 862.551, 877.452, 888.352, 894.997, 897.23,
+        894.997, 888.352, 877.452, 862.551, 843.98, 822.134, 797.453, 770.396, 741.43, 711.012,
+        679.573, 647.515, 615.588, 609.584, 638.87, 668.859, 698.023, 725.974, 752.301, 776.579,
+        798.38, 817.295, 832.943, 844.995, 853.184, 857.327, 857.327, 853.184, 844.995, 832.943,
+        817.295, 798.38, 776.579, 752.301, 725.974, 698.023, 668.859, 638.87, 609.584, 602.607,
+        629.111, 657.024, 683.932, 709.464, 733.233, 754.845, 773.919, 790.093, 803.043, 812.5,
+        818.259, 820.193, 818.259, 812.5, 803.043, 790.093, 773.919, 754.845, 733.233, 709.464,
+        683.932, 657.024, 629.111, 602.607, 594.709, 618.348, 644.169, 668.859, 692.036, 713.342,
+        732.421, 748.93, 762.559, 773.036, 780.147, 783.741, 783.741, 780.147, 773.036, 762.559,
+        748.93, 732.421, 713.342, 692.036, 668.859, 644.169, 618.348, 594.709, 585.951, 607.963,
+        630.399, 652.923, 673.826, 692.78, 709.464, 723.58, 734.861, 743.087, 748.091, 749.771,
+        748.091, 743.087, 734.861, 723.58, 709.464, 692.78, 673.826, 652.923, 630.399, 607.963,
+        585.951, 576.398, 596.799, 616.138, 636.246, 654.969, 671.691, 686.128, 698.023, 707.153,
+        713.342, 716.468, 716.468, 713.342, 707.153, 698.023, 686.128, 671.691, 654.969, 636.246,
+        616.138, 596.799, 576.398, 566.117, 584.934, 602.607, 618.947, 635.592, 650.21, 662.553,
+        672.401, 679.573, 683.932, 685.395, 683.932, 679.573, 672.401, 662.553, 650.21, 635.592,
+        618.947, 602.607, 584.934, 566.117, 555.177, 572.448, 588.506, 603.139, 616.138, 628.468,
+        638.87, 646.844, 652.243, 654.969, 654.969, 652.243, 646.844, 638.87, 628.468, 616.138,
+        603.139, 588.506, 572.448, 555.177, 543.65, 559.419, 573.924, 586.971, 598.374, 607.963,
+        615.588, 621.464, 625.27, 626.546, 625.27, 621.464, 615.588, 607.963, 598.374, 586.971,
+        573.924, 559.419, 543.65, 531.608, 545.926, 558.945, 570.488, 580.391, 588.506, 594.709,
+        598.901, 601.014, 601.014, 598.901, 594.709, 588.506, 580.391, 570.488, 558.945, 545.926,
+        531.608, 519.12, 532.047, 543.65, 553.774, 562.274, 569.025, 573.924, 576.895, 577.89,
+        576.895, 573.924, 569.025, 562.274, 553.774, 543.65, 532.047, 519.12, 506.257, 517.854,
+        528.118, 536.909, 544.104, 549.598, 553.308, 555.177, 555.177, 553.308, 549.598, 544.104,
+        536.909, 528.118, 517.854, 506.257, 493.087, 503.42, 512.42, 519.967, 525.954, 530.295,
+        532.926, 533.807, 532.926, 530.295, 525.954, 519.967, 512.42, 503.42, 493.087, 479.673,
+        488.811, 496.627, 503.016, 507.89, 511.179, 512.835, 512.835, 511.179, 507.89, 503.016,
+        496.627, 488.811, 479.673, 466.078, 474.091, 480.801, 486.119, 489.971, 492.305, 493.087,
+        492.305, 489.971, 486.119, 480.801, 474.091, 466.078, 452.361, 459.319, 465.001, 469.331,
+        472.252, 473.722, 473.722, 472.252, 469.331, 465.001, 459.319, 452.361, 438.576, 444.55,
+        449.28, 452.705, 454.778, 455.472, 454.778, 452.705, 449.28, 444.55, 438.576, 428.107,
+        431.569, 434.196, 436.284, 437.592, 437.592, 436.284, 434.196, 431.569, 428.107, 418.617,
+        421.531, 423.634, 424.904, 425.328, 424.904, 423.634, 421.531, 418.617, 409.077, 411.478,
+        413.092, 413.902, 413.902, 413.092, 411.478, 409.077, 399.511, 401.433, 402.593, 402.981,
+        402.593, 401.433, 399.511, 389.942, 391.418, 392.159, 392.159, 391.418, 389.942, 380.391,
+        381.453, 381.808, 381.453, 380.391, 370.879, 371.558, 371.558, 370.879, 361.422, 361.748,
+        361.422, 352.038, 352.038, 342.741,
+    },
+    {
+        3652.88, 3324.41, 3025.48, 2753.43, 3324.41, 3197.17, 2958.93, 2711.65, 3025.48, 2958.93,
+        2798.3, 2600.72, 2753.43, 2711.65, 2600.72, 2449.2, 2505.84, 2505.84, 2280.51, 2476.94,
+        2476.94, 2280.51, 2075.45, 2259.34, 2396.81, 2396.81, 2259.34, 2075.45, 1893.93, 2059.33,
+        2199.23, 2280.51, 2280.51, 2199.23, 2059.33, 1893.93, 1729.95, 1881.78, 2013.39, 2108.77,
+        2143.65, 2108.77, 2013.39, 1881.78, 1729.95, 1580.16, 1720.22, 1846.49, 1944.64, 1999.12,
+        1999.12, 1944.64, 1846.49, 1720.22, 1580.16, 1443.35, 1572.26, 1691.8, 1791.2, 1858.06,
+        1881.78, 1858.06, 1791.2, 1691.8, 1572.26, 1443.35, 1318.38, 1436.84, 1549.05, 1646.78,
+        1720.22, 1759.93, 1759.93, 1720.22, 1646.78, 1549.05, 1436.84, 1318.38, 1204.23, 1312.97,
+        1417.69, 1512.01, 1588.16, 1638.11, 1655.56, 1638.11, 1588.16, 1512.01, 1417.69, 1312.97,
+        1204.23, 1110.39, 1199.7, 1297.02, 1386.93, 1463.24, 1519.26, 1549.05, 1549.05, 1519.26,
+        1463.24, 1386.93, 1297.02, 1199.7, 1110.39, 1034.65, 1107.39, 1186.31, 1271.27, 1346.09,
+        1405.22, 1443.35, 1456.54, 1443.35, 1405.22, 1346.09, 1271.27, 1186.31, 1107.39, 1034.65,
+        964.067, 1032.04, 1098.46, 1164.62, 1236.87, 1297.02, 1340.45, 1363.28, 1363.28, 1340.45,
+        1297.02, 1236.87, 1164.62, 1098.46, 1032.04, 964.067, 898.302, 961.802, 1024.31, 1083.91,
+        1138.27, 1195.21, 1241.67, 1271.27, 1281.45, 1271.27, 1241.67, 1195.21, 1138.27, 1083.91,
+        1024.31, 961.802, 898.302, 837.023, 896.323, 955.067, 1011.67, 1064.19, 1110.39, 1147.89,
+        1181.91, 1199.7, 1199.7, 1181.91, 1147.89, 1110.39, 1064.19, 1011.67, 955.067, 896.323,
+        837.023, 779.925, 835.287, 890.434, 944.044, 994.493, 1039.9, 1078.2, 1107.39, 1125.7,
+        1131.95, 1125.7, 1107.39, 1078.2, 1039.9, 994.493, 944.044, 890.434, 835.287, 779.925,
+        727.664, 778.396, 830.118, 880.779, 929.016, 973.233, 1011.67, 1042.54, 1064.19, 1075.37,
+        1075.37, 1064.19, 1042.54, 1011.67, 973.233, 929.016, 880.779, 830.118, 778.396, 727.664,
+        682.204, 726.431, 773.844, 821.632, 867.586, 910.353, 948.424, 980.22, 1004.24, 1019.22,
+        1024.31, 1019.22, 1004.24, 980.22, 948.424, 910.353, 867.586, 821.632, 773.844, 726.431,
+        682.204, 639.583, 681.105, 722.753, 766.362, 810.013, 851.154, 888.487, 920.632, 946.229,
+        964.067, 973.233, 973.233, 964.067, 946.229, 920.632, 888.487, 851.154, 810.013, 766.362,
+        722.753, 681.105, 639.583, 599.625, 638.602, 677.828, 716.698, 756.1, 795.505, 831.835,
+        863.884, 890.434, 910.353, 922.714, 926.906, 922.714, 910.353, 890.434, 863.884, 831.835,
+        795.505, 756.1, 716.698, 677.828, 638.602, 599.625, 562.164, 598.747, 635.674, 672.427,
+        708.373, 743.258, 778.396, 810.013, 837.023, 858.385, 873.195, 880.779, 880.779, 873.195,
+        858.385, 837.023, 810.013, 778.396, 743.258, 708.373, 672.427, 635.674, 598.747, 562.164,
+        527.043, 561.376, 596.126, 630.846, 664.993, 697.923, 728.901, 759.007, 786.091, 808.378,
+        825.007, 835.287, 838.766, 835.287, 825.007, 808.378, 786.091, 759.007, 728.901, 697.923,
+        664.993, 630.846, 596.126, 561.376, 527.043, 494.116, 526.335, 559.025, 591.801, 624.193,
+        655.645, 685.519, 713.109, 737.673, 760.468, 778.396, 790.773, 797.094, 797.094, 790.773,
+        778.396, 760.468, 737.673, 713.109, 685.519, 655.645, 624.193, 591.801, 559.025, 526.335,
+        494.116, 466.164, 493.479, 524.222, 555.142, 585.834, 615.815, 644.528, 671.356, 695.638,
+        716.698, 733.889, 747.496, 756.1, 759.007, 756.1, 747.496, 733.889, 716.698, 695.638,
+        671.356, 644.528, 615.815, 585.834, 555.142, 524.222, 493.479, 466.164, 439.945, 465.646,
+        491.668, 520.731, 549.782, 578.311, 605.834, 631.807, 655.645, 676.741, 694.5, 708.373,
+        717.902, 722.753, 722.753, 717.902, 708.373, 694.5, 676.741, 655.645, 631.807, 605.834,
+        578.311, 549.782, 520.731, 491.668, 465.646, 439.945, 415.2, 439.474, 464.096, 488.844,
+        515.906, 543.015, 569.335, 594.39, 617.66, 638.602, 656.672, 671.356, 682.204, 688.862,
+        691.108, 688.862, 682.204, 671.356, 656.672, 638.602, 617.66, 594.39, 569.335, 543.015,
+        515.906, 488.844, 464.096, 439.474, 415.2, 391.847, 414.771, 438.065, 461.532, 484.937,
+        509.81, 534.931, 559.025, 581.634, 602.273, 620.445, 635.674, 647.527, 655.645, 659.771,
+        659.771, 655.645, 647.527, 635.674, 620.445, 602.273, 581.634, 559.025, 534.931, 509.81,
+        484.937, 461.532, 438.065, 414.771, 391.847, 369.808, 391.456, 413.489, 435.734, 457.982,
+        479.991, 502.518, 525.629, 547.511, 567.728, 585.834, 601.388, 613.979, 623.252, 628.933,
+        630.846, 628.933, 623.252, 613.979, 601.388, 585.834, 567.728, 547.511, 525.629, 502.518,
+        479.991, 457.982, 435.734, 413.489, 391.456, 369.808, 349.008, 369.451, 390.288, 411.366,
+        432.503, 453.484, 474.058, 494.116, 515.223, 534.931, 552.834, 568.531, 581.634, 591.801,
+        598.747, 602.273, 602.273, 598.747, 591.801, 581.634, 568.531, 552.834, 534.931, 515.223,
+        494.116, 474.058, 453.484, 432.503, 411.366, 390.288, 369.451, 349.008, 348.682, 368.385,
+        388.352, 408.423, 428.408, 448.084, 467.204, 485.492, 503.831, 521.426, 537.116, 550.542,
+        561.376, 569.335, 574.202, 575.84, 574.202, 569.335, 561.376, 550.542, 537.116, 521.426,
+        503.831, 485.492, 467.204, 448.084, 428.408, 408.423, 388.352, 368.385, 348.682, 347.708,
+        366.618, 385.668, 404.69, 423.487, 441.838, 459.498, 476.201, 491.668, 507.139, 520.731,
+        532.04, 540.79, 546.757, 549.782, 549.782, 546.757, 540.79, 532.04, 520.731, 507.139,
+        491.668, 476.201, 459.498, 441.838, 423.487, 404.69, 385.668, 366.618, 347.708, 346.094,
+        364.168, 382.261, 400.2, 417.788, 434.807, 451.016, 466.164, 479.991, 492.236, 503.831,
+        513.182, 520.037, 524.222, 525.629, 524.222, 520.037, 513.182, 503.831, 492.236, 479.991,
+        466.164, 451.016, 434.807, 417.788, 400.2, 382.261, 364.168, 346.094, 343.854, 361.054,
+        378.16, 394.996, 411.366, 427.056, 441.838, 455.474, 467.726, 478.36, 487.164, 494.116,
+        499.259, 501.863, 501.863, 499.259, 494.116, 487.164, 478.36, 467.726, 455.474, 441.838,
+        427.056, 411.366, 394.996, 378.16, 361.054, 343.854, 341.123, 357.305, 373.403, 389.125,
+        404.278, 418.657, 432.045, 444.223, 454.975, 464.096, 471.402, 476.74, 479.991, 481.083,
+        479.991, 476.74, 471.402, 464.096, 454.975, 444.223, 432.045, 418.657, 404.278, 389.125,
+        373.403, 357.305, 341.123, 337.924, 352.953, 368.03, 382.637, 396.586, 409.68, 421.72,
+        432.503, 441.838, 449.546, 455.474, 459.498, 461.532, 461.532, 459.498, 455.474, 449.546,
+        441.838, 432.503, 421.72, 409.68, 396.586, 382.637, 368.03, 352.953, 337.924, 334.205,
+        348.032, 362.087, 375.587, 388.352, 400.2, 410.944, 420.403, 428.408, 434.807, 439.474,
+        442.313, 443.267, 442.313, 439.474, 434.807, 428.408, 420.403, 410.944, 400.2, 388.352,
+        375.587, 362.087, 348.032, 334.205, 329.994, 342.592, 355.621, 368.03, 379.643, 390.288,
+        399.796, 408.006, 414.771, 419.965, 423.487, 425.265, 425.265, 423.487, 419.965, 414.771,
+        408.006, 399.796, 390.288, 379.643, 368.03, 355.621, 342.592, 329.994, 325.322, 337.06,
+        348.682, 360.026, 370.522, 380.015, 388.352, 395.392, 401.01, 405.102, 407.589, 408.423,
+        407.589, 405.102, 401.01, 395.392, 388.352, 380.015, 370.522, 360.026, 348.682, 337.06,
+        325.322, 320.223, 331.109, 341.416, 351.63, 361.054, 369.451, 376.686, 382.637, 387.198,
+        390.288, 391.847, 391.847, 390.288, 387.198, 382.637, 376.686, 369.451, 361.054, 351.63,
+        341.416, 331.109, 320.223, 314.73, 324.779, 334.205, 342.901, 351.301, 358.661, 364.865,
+        369.808, 373.403, 375.587, 376.319, 375.587, 373.403, 369.808, 364.865, 358.661, 351.301,
+        342.901, 334.205, 324.779, 314.73, 308.883, 318.113, 326.685, 334.489, 341.416, 347.708,
+        352.953, 356.967, 359.684, 361.054, 361.054, 359.684, 356.967, 352.953, 347.708, 341.416,
+        334.489, 326.685, 318.113, 308.883, 302.716, 311.151, 318.901, 325.866, 331.949, 337.06,
+        341.123, 344.173, 346.094, 346.738, 346.094, 344.173, 341.123, 337.06, 331.949, 325.866,
+        318.901, 311.151, 302.716, 296.268, 303.934, 310.897, 317.066, 322.354, 326.685, 329.994,
+        332.23, 333.356, 333.356, 332.23, 329.994, 326.685, 322.354, 317.066, 310.897, 303.934,
+        296.268, 289.576, 296.503, 302.716, 308.132, 312.677, 316.284, 318.901, 320.488, 321.019,
+        320.488, 318.901, 316.284, 312.677, 308.132, 302.716, 296.503, 289.576, 282.676, 288.897,
+        294.398, 299.107, 302.959, 305.898, 307.883, 308.883, 308.883, 307.883, 305.898, 302.959,
+        299.107, 294.398, 288.897, 282.676, 275.603, 281.153, 285.983, 290.03, 293.239, 295.565,
+        296.974, 297.446, 296.974, 295.565, 293.239, 290.03, 285.983, 281.153, 275.603, 268.393,
+        273.306, 277.505, 280.936, 283.552, 285.316, 286.205, 286.205, 285.316, 283.552, 280.936,
+        277.505, 273.306, 268.393, 261.078, 265.391, 269, 271.859, 273.93, 275.184, 275.603,
+        275.184, 273.93, 271.859, 269, 265.391, 261.078, 253.688, 257.438, 260.498, 262.829,
+        264.401, 265.192, 265.192, 264.401, 262.829, 260.498, 257.438, 253.688, 246.253, 249.476,
+        252.027, 253.873, 254.991, 255.365, 254.991, 253.873, 252.027, 249.476, 246.253, 240.403,
+        242.368, 243.859, 245.016, 245.722, 245.722, 245.016, 243.859, 242.368, 240.403, 235.018,
+        236.672, 237.865, 238.585, 238.826, 238.585, 237.865, 236.672, 235.018, 229.606, 230.968,
+        231.883, 232.343, 232.343, 231.883, 230.968, 229.606, 224.181, 225.271, 225.929, 226.149,
+        225.929, 225.271, 224.181, 218.755, 219.592, 220.012, 220.012, 219.592, 218.755, 213.341,
+        213.943, 214.144, 213.943, 213.341, 207.951, 208.335, 208.335, 207.951, 202.593, 202.777,
+        202.593, 197.278, 197.278, 192.013,
+    },
+    {
+        1901.77, 1520.48, 1215.64, 971.921, 1520.48, 1385.89, 1153.1, 937.263, 1215.64, 1153.1,
+        1009.96, 848.763, 971.921, 937.263, 848.763, 735.998, 777.062, 777.062, 621.27, 755.949,
+        755.949, 621.27, 496.712, 607.656, 699.158, 699.158, 607.656, 496.712, 410.869, 487.598,
+        569.97, 621.27, 621.27, 569.97, 487.598, 410.869, 344.012, 405.716, 463.235, 515.86,
+        536.352, 515.86, 463.235, 405.716, 344.012, 288.034, 340.229, 390.93, 432.723, 456.816,
+        456.816, 432.723, 390.93, 340.229, 288.034, 241.164, 285.214, 329.293, 368.306, 395.75,
+        405.716, 395.75, 368.306, 329.293, 285.214, 241.164, 201.921, 239.037, 277.019, 312.33,
+        340.229, 355.802, 355.802, 340.229, 312.33, 277.019, 239.037, 201.921, 169.064, 200.301,
+        232.83, 264.176, 290.898, 309.112, 315.605, 309.112, 290.898, 264.176, 232.83, 200.301,
+        169.064, 141.617, 167.82, 195.557, 223.024, 247.725, 266.667, 277.019, 277.019, 266.667,
+        247.725, 223.024, 195.557, 167.82, 141.617, 118.684, 140.659, 164.167, 188.016, 210.328,
+        228.829, 241.164, 245.508, 241.164, 228.829, 210.328, 188.016, 164.167, 140.659, 118.684,
+        99.4641, 117.938, 137.841, 158.331, 178.168, 195.557, 208.605, 215.63, 215.63, 208.605,
+        195.557, 178.168, 158.331, 137.841, 117.938, 99.4641, 83.357, 98.8807, 115.74, 133.322,
+        150.673, 166.589, 179.527, 188.016, 190.979, 188.016, 179.527, 166.589, 150.673, 133.322,
+        115.74, 98.8807, 83.357, 69.8583, 82.8985, 97.1587, 112.203, 127.341, 141.617, 153.878,
+        162.975, 167.82, 167.82, 162.975, 153.878, 141.617, 127.341, 112.203, 97.1587, 82.8985,
+        69.8583, 58.5456, 69.4966, 81.5434, 94.3789, 107.5, 120.195, 131.573, 140.659, 146.548,
+        148.59, 146.548, 140.659, 131.573, 120.195, 107.5, 94.3789, 81.5434, 69.4966, 58.5456,
+        50.1831, 58.2592, 68.4263, 79.3506, 90.6671, 101.846, 112.203, 120.96, 127.341, 130.711,
+        130.711, 127.341, 120.96, 112.203, 101.846, 90.6671, 79.3506, 68.4263, 58.2592, 50.1831,
+        46.7938, 50.0909, 57.411, 66.6906, 76.412, 86.1813, 95.4775, 103.684, 110.153, 114.307,
+        115.74, 114.307, 110.153, 103.684, 95.4775, 86.1813, 76.412, 66.6906, 57.411, 50.0909,
+        46.7938, 43.6334, 46.7121, 49.8161, 56.0331, 64.3575, 72.8446, 81.0984, 88.6351, 94.926,
+        99.4641, 101.846, 101.846, 99.4641, 94.926, 88.6351, 81.0984, 72.8446, 64.3575, 56.0331,
+        49.8161, 46.7121, 43.6334, 40.6864, 43.5608, 46.4685, 49.3639, 54.1758, 61.5139, 68.7806,
+        75.5993, 81.5434, 86.1813, 89.1372, 90.1532, 89.1372, 86.1813, 81.5434, 75.5993, 68.7806,
+        61.5139, 54.1758, 49.3639, 46.4685, 43.5608, 40.6864, 37.9385, 40.6218, 43.3444, 46.0673,
+        48.7426, 51.9043, 58.2592, 64.3575, 69.8583, 74.4019, 77.6531, 79.3506, 79.3506, 77.6531,
+        74.4019, 69.8583, 64.3575, 58.2592, 51.9043, 48.7426, 46.0673, 43.3444, 40.6218, 37.9385,
+        35.3761, 37.8809, 40.4291, 42.9877, 45.5155, 47.9636, 50.2756, 54.6981, 59.7098, 64.033,
+        67.3777, 69.4966, 70.2226, 69.4966, 67.3777, 64.033, 59.7098, 54.6981, 50.2756, 47.9636,
+        45.5155, 42.9877, 40.4291, 37.8809, 35.3761, 32.9868, 35.3246, 37.7089, 40.1112, 42.4964,
+        44.8224, 47.0403, 49.0959, 50.9346, 54.9617, 58.2592, 60.603, 61.8216, 61.8216, 60.603,
+        58.2592, 54.9617, 50.9346, 49.0959, 47.0403, 44.8224, 42.4964, 40.1112, 37.7089, 35.3246,
+        32.9868, 31.2352, 32.9408, 35.1709, 37.4251, 39.673, 41.8785, 43.9992, 45.9878, 47.7934,
+        49.3639, 50.6486, 52.6474, 54.1758, 54.6981, 54.1758, 52.6474, 50.6486, 49.3639, 47.7934,
+        45.9878, 43.9992, 41.8785, 39.673, 37.4251, 35.1709, 32.9408, 31.2352, 29.6014, 31.2029,
+        32.818, 34.9171, 37.0335, 39.1211, 41.1432, 43.0586, 44.8224, 46.3878, 47.7087, 48.7426,
+        49.4537, 49.8161, 49.8161, 49.4537, 48.7426, 47.7087, 46.3878, 44.8224, 43.0586, 41.1432,
+        39.1211, 37.0335, 34.9171, 32.818, 31.2029, 29.6014, 28.053, 29.572, 31.1066, 32.6431,
+        34.5666, 36.5397, 38.4633, 40.3014, 42.0145, 43.5608, 44.8985, 45.9878, 46.7938, 47.2891,
+        47.4562, 47.2891, 46.7938, 45.9878, 44.8985, 43.5608, 42.0145, 40.3014, 38.4633, 36.5397,
+        34.5666, 32.6431, 31.1066, 29.572, 28.053, 26.5857, 28.0261, 29.484, 30.947, 32.4009,
+        34.1241, 35.9504, 37.7089, 39.3648, 40.8811, 42.2199, 43.3444, 44.2211, 44.8224, 45.1282,
+        45.1282, 44.8224, 44.2211, 43.3444, 42.2199, 40.8811, 39.3648, 37.7089, 35.9504, 34.1241,
+        32.4009, 30.947, 29.484, 28.0261, 26.5857, 25.1951, 26.5611, 27.9457, 29.3383, 30.7261,
+        32.0941, 33.5953, 35.2733, 36.8677, 38.3457, 39.673, 40.8161, 41.7432, 42.427, 42.8463,
+        42.9877, 42.8463, 42.427, 41.7432, 40.8161, 39.673, 38.3457, 36.8677, 35.2733, 33.5953,
+        32.0941, 30.7261, 29.3383, 27.9457, 26.5611, 25.1951, 23.8772, 25.1725, 26.4875, 27.8125,
+        29.1364, 30.4459, 31.7258, 32.9868, 34.517, 35.9504, 37.2565, 38.4044, 39.3648, 40.1112,
+        40.6218, 40.8811, 40.8811, 40.6218, 40.1112, 39.3648, 38.4044, 37.2565, 35.9504, 34.517,
+        32.9868, 31.7258, 30.4459, 29.1364, 27.8125, 26.4875, 25.1725, 23.8772, 23.8565, 25.1051,
+        26.3655, 27.6279, 28.8803, 30.1093, 31.2998, 32.4353, 33.6905, 34.9676, 36.1096, 37.0891,
+        37.8809, 38.4633, 38.8199, 38.9399, 38.8199, 38.4633, 37.8809, 37.0891, 36.1096, 34.9676,
+        33.6905, 32.4353, 31.2998, 30.1093, 28.8803, 27.6279, 26.3655, 25.1051, 23.8565, 23.7947,
+        24.9933, 26.1964, 27.3934, 28.5723, 29.7196, 30.8204, 31.8588, 32.818, 33.9303, 34.9171,
+        35.7398, 36.3775, 36.8127, 37.0335, 37.0335, 36.8127, 36.3775, 35.7398, 34.9171, 33.9303,
+        32.818, 31.8588, 30.8204, 29.7196, 28.5723, 27.3934, 26.1964, 24.9933, 23.7947, 23.6921,
+        24.8383, 25.9815, 27.1112, 28.2153, 29.2804, 30.2921, 31.2352, 32.0941, 32.8532, 33.6905,
+        34.3688, 34.8667, 35.1709, 35.2733, 35.1709, 34.8667, 34.3688, 33.6905, 32.8532, 32.0941,
+        31.2352, 30.2921, 29.2804, 28.2153, 27.1112, 25.9815, 24.8383, 23.6921, 23.5498, 24.6411,
+        25.7228, 26.7839, 27.8125, 28.7957, 29.7196, 30.5699, 31.3323, 31.9929, 32.5389, 32.9868,
+        33.3592, 33.5479, 33.5479, 33.3592, 32.9868, 32.5389, 31.9929, 31.3323, 30.5699, 29.7196,
+        28.7957, 27.8125, 26.7839, 25.7228, 24.6411, 23.5498, 23.3688, 24.4036, 25.4223, 26.4142,
+        27.3675, 28.2697, 29.1078, 29.8685, 30.5388, 31.1066, 31.5608, 31.8923, 32.0941, 32.1618,
+        32.0941, 31.8923, 31.5608, 31.1066, 30.5388, 29.8685, 29.1078, 28.2697, 27.3675, 26.4142,
+        25.4223, 24.4036, 23.3688, 23.1505, 24.1276, 25.0827, 26.0052, 26.8839, 27.7068, 28.4616,
+        29.1364, 29.7196, 30.2005, 30.5699, 30.8204, 30.947, 30.947, 30.8204, 30.5699, 30.2005,
+        29.7196, 29.1364, 28.4616, 27.7068, 26.8839, 26.0052, 25.0827, 24.1276, 23.1505, 22.8967,
+        23.8153, 24.7065, 25.5603, 26.3655, 27.1112, 27.786, 28.3791, 28.8803, 29.2804, 29.572,
+        29.7493, 29.8088, 29.7493, 29.572, 29.2804, 28.8803, 28.3791, 27.786, 27.1112, 26.3655,
+        25.5603, 24.7065, 23.8153, 22.8967, 22.6093, 23.4691, 24.2968, 25.0827, 25.8164, 26.4875,
+        27.0858, 27.6016, 28.0261, 28.3517, 28.5723, 28.6836, 28.6836, 28.5723, 28.3517, 28.0261,
+        27.6016, 27.0858, 26.4875, 25.8164, 25.0827, 24.2968, 23.4691, 22.6093, 22.2904, 23.0915,
+        23.8565, 24.576, 25.2403, 25.8398, 26.3655, 26.8088, 27.1622, 27.4193, 27.5755, 27.6279,
+        27.5755, 27.4193, 27.1622, 26.8088, 26.3655, 25.8398, 25.2403, 24.576, 23.8565, 23.0915,
+        22.2904, 21.9423, 22.6854, 23.3888, 24.0436, 24.6411, 25.1725, 25.6297, 26.0052, 26.2928,
+        26.4875, 26.5857, 26.5857, 26.4875, 26.2928, 26.0052, 25.6297, 25.1725, 24.6411, 24.0436,
+        23.3888, 22.6854, 21.9423, 21.5674, 22.2533, 22.8967, 23.4892, 24.0227, 24.4895, 24.8824,
+        25.1951, 25.4223, 25.5603, 25.6065, 25.5603, 25.4223, 25.1951, 24.8824, 24.4895, 24.0227,
+        23.4892, 22.8967, 22.2533, 21.5674, 21.1682, 21.7983, 22.3834, 22.9161, 23.3888, 23.7947,
+        24.1276, 24.3822, 24.5543, 24.6411, 24.6411, 24.5543, 24.3822, 24.1276, 23.7947, 23.3888,
+        22.9161, 22.3834, 21.7983, 21.1682, 20.7472, 21.323, 21.8521, 22.3275, 22.7427, 23.0915,
+        23.3688, 23.57, 23.6921, 23.7331, 23.6921, 23.57, 23.3688, 23.0915, 22.7427, 22.3275,
+        21.8521, 21.323, 20.7472, 20.3069, 20.8303, 21.3057, 21.7268, 22.0878, 22.3834, 22.6093,
+        22.7619, 22.8387, 22.8387, 22.7619, 22.6093, 22.3834, 22.0878, 21.7268, 21.3057, 20.8303,
+        20.3069, 19.8499, 20.323, 20.7472, 21.117, 21.4272, 21.6735, 21.8521, 21.9604, 21.9967,
+        21.9604, 21.8521, 21.6735, 21.4272, 21.117, 20.7472, 20.323, 19.8499, 19.3787, 19.8036,
+        20.1792, 20.5008, 20.7638, 20.9644, 21.0999, 21.1682, 21.1682, 21.0999, 20.9644, 20.7638,
+        20.5008, 20.1792, 19.8036, 19.3787, 18.8957, 19.2747, 19.6046, 19.8809, 20.1001, 20.2589,
+        20.3551, 20.3873, 20.3551, 20.2589, 20.1001, 19.8809, 19.6046, 19.2747, 18.8957, 18.4033,
+        18.7388, 19.0256, 19.2599, 19.4386, 19.5591, 19.6198, 19.6198, 19.5591, 19.4386, 19.2599,
+        19.0256, 18.7388, 18.4033, 17.9035, 18.1982, 18.4447, 18.64, 18.7814, 18.8671, 18.8957,
+        18.8671, 18.7814, 18.64, 18.4447, 18.1982, 17.9035, 17.3987, 17.6549, 17.8639, 18.0232,
+        18.1306, 18.1846, 18.1846, 18.1306, 18.0232, 17.8639, 17.6549, 17.3987, 16.8907, 17.1109,
+        17.2852, 17.4114, 17.4877, 17.5133, 17.4877, 17.4114, 17.2852, 17.1109, 16.8907, 16.466,
+        16.6123, 16.7233, 16.8062, 16.8544, 16.8544, 16.8062, 16.7233, 16.6123, 16.466, 16.0658,
+        16.1886, 16.2773, 16.3309, 16.3488, 16.3309, 16.2773, 16.1886, 16.0658, 15.6644, 15.7653,
+        15.8332, 15.8673, 15.8673, 15.8332, 15.7653, 15.6644, 15.2628, 15.3434, 15.3921, 15.4084,
+        15.3921, 15.3434, 15.2628, 14.862, 14.9237, 14.9547, 14.9547, 14.9237, 14.862, 14.4629,
+        14.5072, 14.522, 14.5072, 14.4629, 14.0664, 14.0946, 14.0946, 14.0664, 13.6732, 13.6867,
+        13.6732, 13.284, 13.284, 12.8994,
+    },
+};
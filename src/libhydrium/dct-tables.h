@@ -0,0 +1,11 @@
+/*
+ * Quantization weights of the larger square DCTs
+ */
+#ifndef HYD_DCT_TABLES_H_
+#define HYD_DCT_TABLES_H_
+
+/* in natural coefficient order and for globalScale = 32768, like the DCT8 ones in encoder.c */
+extern const float hyd_dct16_weights[3][256];
+extern const float hyd_dct32_weights[3][1024];
+
+#endif /* HYD_DCT_TABLES_H_ */
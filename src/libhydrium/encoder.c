@@ -6,19 +6,100 @@
 #include <string.h>
 
 #include "bitwriter.h"
+#include "dct-tables.h"
 #include "encoder.h"
 #include "entropy.h"
 #include "internal.h"
 #include "math-functions.h"
 #include "memory.h"
+#include "static-codes.h"
+
+/* most HF clusters a preset can split into, if there are enough to go around */
+#define HF_MAX_CLUSTERS_PER_PRESET 64
+
+/* for picking AC strategies: bits per coefficient that survives quantization, on top of 2 * log2 of it */
+#define ACS_BITS_PER_COEFF 4.f
+/* bits per zero coded before the last such coefficient */
+#define ACS_BITS_PER_ZERO 1.f
+/* and bits per unit of squared error, in DCT8 quant steps */
+#define ACS_BITS_PER_ERROR 16.f
+
+/* for rate-distortion optimized quantization: bits per unit of squared error, in DCT8 quant steps */
+#define QUANT_BITS_PER_ERROR 64.f
+
+/* size estimates: how many tokens the HF and LF hybrid uint configs can produce */
+#define HF_TALLY_TOKENS 72
+#define LF_TALLY_TOKENS 256
+/* and bytes on top of the coded symbols, for the image header, each frame's HF histograms, and each group */
+#define ESTIMATE_HEADER_BYTES 32
+#define ESTIMATE_FRAME_BYTES 256
+#define ESTIMATE_GROUP_BYTES 4
+/* adaptive codes split HF contexts up finer than the static clusters the estimates use */
+#define ESTIMATE_HF_CLUSTER_GAIN 0.92f
 
 typedef struct IntPos {
     uint8_t x, y;
 } IntPos;
 
-typedef struct uint8_vec3 {
-    uint8_t v[3];
-} uint8_vec3;
+typedef struct uint16_vec3 {
+    uint16_t v[3];
+} uint16_vec3;
+
+/* the AC strategies we pick from, by their ids in the bitstream */
+enum {
+    ACS_DCT8 = 0,
+    ACS_DCT16 = 4,
+    ACS_DCT32 = 5,
+    /* not an id: a block inside a larger varblock, past its top-left one */
+    ACS_COVERED = 0xFF,
+};
+
+/* where a varblock's coefficients go in the XYB buffer, for one square DCT size */
+typedef struct VarblockLayout {
+    /* in blocks */
+    size_t side;
+    size_t size;
+    /* [3][size], in natural order */
+    const float *weights;
+    /*
+     * What a unit of error in each coefficient costs, in squared DCT8 quant steps at the same
+     * frequency, so different sizes compare fairly: first in the coefficient itself, at hf_scale = 1,
+     * and then in its own quant steps.
+     */
+    float zeroed_error[3][1024];
+    float step_error[3][1024];
+    /* natural order, as positions in the varblock's own coefficient array */
+    uint16_t raster[1024];
+    /* natural order, as offsets into the XYB buffer from the varblock's top-left corner */
+    size_t offsets[1024];
+    /* natural order, the higher of the horizontal and vertical frequency, in DCT8 terms */
+    uint8_t band[1024];
+} VarblockLayout;
+
+typedef struct ACSScratch {
+    /* one 32x32 region, back from the DCT8 */
+    float pixels[3][1024];
+    float tmp[1024];
+    float dct8[64];
+    float dct16[4][3][256];
+    float dct32[3][1024];
+} ACSScratch;
+
+/* what RDO quantization thinks coefficients cost, going by a static preset */
+typedef struct QuantModel {
+    const HYDStaticPreset *preset;
+    /* the cluster of each coefficient context, counted from the first one */
+    uint8_t clusters[3 * 458];
+    /* bits for the small symbols of each cluster */
+    float bits[HYD_STATIC_HF_CLUSTERS][64];
+} QuantModel;
+
+/* the HF symbols of an LF group by static cluster, for estimating its size without coding them */
+typedef struct HFTally {
+    uint32_t tokens[HYD_STATIC_HF_CLUSTERS][HF_TALLY_TOKENS];
+    /* raw bits after the tokens, or every bit if the codes are static */
+    float bits;
+} HFTally;
 
 static const uint8_t level10_header[49] = {
     0x00, 0x00, 0x00, 0x0c,  'J',  'X',  'L',  ' ',
@@ -71,7 +152,7 @@ static const size_t coeff_num_non_zero_context[64] = {
 //     7, 8, 9, 9, 10, 11, 12, 13, 14, 14, 14, 14, 14,
 // };
 
-static const int32_t hf_quant_weights[3][64] = {
+static const float hf_quant_weights[3][64] = {
     {
         1969, 1969, 1969, 1962, 1969, 1962, 1655, 1885, 1885, 1655, 1397, 1610, 1704, 1610, 1397, 1178,
         1368, 1494, 1494, 1368, 1178,  994, 1159, 1289, 1340, 1289, 1159,  994,  839,  980, 1104, 1178,
@@ -92,13 +173,36 @@ static const int32_t hf_quant_weights[3][64] = {
     },
 };
 
-static const uint16_t hf_mult = 5;
+/* cos(pi * m / 64), for the DCTs that pick the larger transforms */
+static const float dct_cos[128] = {
+    1, 0.998795, 0.995185, 0.989177, 0.980785, 0.970031, 0.95694, 0.941544,
+    0.92388, 0.903989, 0.881921, 0.857729, 0.83147, 0.803208, 0.77301, 0.740951,
+    0.707107, 0.671559, 0.634393, 0.595699, 0.55557, 0.514103, 0.471397, 0.427555,
+    0.382683, 0.33689, 0.290285, 0.24298, 0.19509, 0.14673, 0.0980171, 0.0490677,
+    0, -0.0490677, -0.0980171, -0.14673, -0.19509, -0.24298, -0.290285, -0.33689,
+    -0.382683, -0.427555, -0.471397, -0.514103, -0.55557, -0.595699, -0.634393, -0.671559,
+    -0.707107, -0.740951, -0.77301, -0.803208, -0.83147, -0.857729, -0.881921, -0.903989,
+    -0.92388, -0.941544, -0.95694, -0.970031, -0.980785, -0.989177, -0.995185, -0.998795,
+    -1, -0.998795, -0.995185, -0.989177, -0.980785, -0.970031, -0.95694, -0.941544,
+    -0.92388, -0.903989, -0.881921, -0.857729, -0.83147, -0.803208, -0.77301, -0.740951,
+    -0.707107, -0.671559, -0.634393, -0.595699, -0.55557, -0.514103, -0.471397, -0.427555,
+    -0.382683, -0.33689, -0.290285, -0.24298, -0.19509, -0.14673, -0.0980171, -0.0490677,
+    0, 0.0490677, 0.0980171, 0.14673, 0.19509, 0.24298, 0.290285, 0.33689,
+    0.382683, 0.427555, 0.471397, 0.514103, 0.55557, 0.595699, 0.634393, 0.671559,
+    0.707107, 0.740951, 0.77301, 0.803208, 0.83147, 0.857729, 0.881921, 0.903989,
+    0.92388, 0.941544, 0.95694, 0.970031, 0.980785, 0.989177, 0.995185, 0.998795,
+};
+
 static const uint64_t zero64 = 0;
 static const void *const zerobuf = &zero64;
 static const U32Table size_header_u32 = {
     .cpos = {1, 1, 1, 1},
     .upos = {9, 13, 18, 30},
 };
+static const U32Table preview_size_u32 = {
+    .cpos = {1, 65, 321, 1345},
+    .upos = {6, 8, 10, 12},
+};
 static const U32Table frame_size_u32 = {
     .cpos = {0, 256, 2304, 18688},
     .upos = {8, 11, 14, 30},
@@ -118,6 +222,87 @@ static const U32Table toc_table = {
     .cpos = {0, 1024, 17408, 4211712},
     .upos = {10, 14, 22, 30},
 };
+/*
+ * HF coefficients go in passes by band: with n passes, pass p codes the ones below pass_bands[n - 1][p]
+ * that the passes before it didn't. Each pass is what it takes to show the frame at pass_downsample
+ * times smaller, which is what the frame header tells decoders.
+ */
+static const uint8_t pass_bands[3][3] = {
+    {8}, {2, 8}, {2, 4, 8},
+};
+static const uint8_t pass_downsample[2] = {4, 2};
+static const U32Table used_orders_table = {
+    .cpos = {0x5F, 0x13, 0, 0},
+    .upos = {0, 0, 0, 13},
+};
+
+static inline HYDEntropyCoding entropy_coding(const HYDEncoder *encoder) {
+    return encoder->metadata.fast_decode ? HYD_CODING_FAST_DECODE : HYD_CODING_AUTO;
+}
+
+/* the image size in coded pixels, which is smaller than the input when upsampling */
+static inline size_t coded_width(const HYDEncoder *encoder) {
+    return hyd_ceil_div(encoder->metadata.width, (size_t)1 << encoder->upsampling_shift);
+}
+
+static inline size_t coded_height(const HYDEncoder *encoder) {
+    return hyd_ceil_div(encoder->metadata.height, (size_t)1 << encoder->upsampling_shift);
+}
+
+/* effort 1 writes symbols as it goes, even if no preset was asked for */
+static inline const HYDStaticPreset *static_preset(const HYDEncoder *encoder) {
+    if (encoder->metadata.entropy_preset)
+        return &hyd_static_presets[encoder->metadata.entropy_preset - 1];
+    return encoder->effort == 1 ? &hyd_static_presets[0] : NULL;
+}
+
+static inline uint32_t lz77_chain_depth(const HYDEncoder *encoder) {
+    if (encoder->effort <= 2)
+        return HYD_LZ77_CHAIN_DEPTH >> 2;
+    return encoder->effort >= 5 ? HYD_LZ77_CHAIN_DEPTH << 2 : HYD_LZ77_CHAIN_DEPTH;
+}
+
+/* effort 2 settles for a handful of clusters, which is quicker to find */
+static inline size_t max_hf_clusters(const HYDEncoder *encoder) {
+    return encoder->effort <= 2 ? HF_MAX_CLUSTERS_PER_PRESET >> 3 : HF_MAX_CLUSTERS_PER_PRESET;
+}
+
+/*
+ * static presets share clusters: non-zero counts by channel and how many are predicted,
+ * then coefficients by channel, whether the previous one was zero, and how far along they are
+ */
+static inline uint8_t static_hf_cluster(size_t context) {
+    static const size_t num_non_zero_levels[8] = { 0, 31, 62, 93, 123, 152, 180, 206 };
+    if (context < 111) {
+        const size_t predicted = context / 3;
+        const uint8_t bucket = !predicted ? 0 : predicted <= 2 ? 1 : predicted <= 5 ? 2 : predicted <= 10 ? 3 : 4;
+        return 5 * (context % 3) + bucket;
+    }
+    context -= 111;
+    const size_t level = (context % 458) >> 1;
+    size_t freq = level;
+    for (int i = 7; i >= 0; i--) {
+        if (num_non_zero_levels[i] <= level) {
+            freq -= num_non_zero_levels[i];
+            break;
+        }
+    }
+    const uint8_t bucket = freq < 4 ? 0 : freq < 15 ? 1 : 2;
+    return 15 + 6 * (context / 458) + 3 * (context & 1) + bucket;
+}
+
+/* a single-dist static stream with its header already written, so its symbols go straight to bw */
+static HYDStatusCode init_static_stream(HYDEncoder *encoder, HYDEntropyStream *stream, const HYDStaticCode *code,
+        HYDBitWriter *bw) {
+    HYDStatusCode ret = hyd_entropy_init_static_stream(stream, zerobuf, 1, code, &encoder->error);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    ret = hyd_entropy_write_stream_header(stream, bw);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    hyd_entropy_set_static_writer(stream, bw);
+    return HYD_OK;
+}
 
 static inline uint32_t icc_context(uint64_t i, uint32_t b1, uint32_t b2)
 {
@@ -182,8 +367,22 @@ static HYDStatusCode write_header(HYDEncoder *encoder) {
     /* all_default */
     hyd_write_bool(bw, 0);
 
-    /* extra_fields */
-    hyd_write_bool(bw, 0);
+    /* extra_fields, which the preview header is in */
+    hyd_write_bool(bw, encoder->metadata.preview);
+    if (encoder->metadata.preview) {
+        /* orientation = 0:3, have_intrinsic_size = 0 */
+        hyd_write(bw, 0, 4);
+        /* have_preview = 1 */
+        hyd_write_bool(bw, 1);
+        /* div8 = 0 */
+        hyd_write_bool(bw, 0);
+        hyd_write_u32(bw, &preview_size_u32, encoder->preview_height);
+        /* ratio = 0 */
+        hyd_write(bw, 0, 3);
+        hyd_write_u32(bw, &preview_size_u32, encoder->preview_width);
+        /* have_animation = 0 */
+        hyd_write_bool(bw, 0);
+    }
 
     /* bit depth bundle */
     /* float samples */
@@ -213,6 +412,10 @@ static HYDStatusCode write_header(HYDEncoder *encoder) {
         hyd_write_bool(bw, 1);
     }
 
+    /* tone_mapping.all_default == 1, which only extra_fields has */
+    if (encoder->metadata.preview)
+        hyd_write_bool(bw, 1);
+
     /* extensions */
     hyd_write_u64(bw, 0);
 
@@ -223,13 +426,14 @@ static HYDStatusCode write_header(HYDEncoder *encoder) {
         HYDEntropyStream icc_stream = { 0 };
         hyd_write_u64(bw, encoder->icc_size);
         hyd_entropy_init_stream(&icc_stream, encoder->icc_size, icc_cluster_map, 41, 0, 0, 0, &encoder->error);
+        hyd_entropy_set_coding(&icc_stream, entropy_coding(encoder));
         uint32_t b1 = 0, b2 = 0;
         for (uint64_t i = 0; i < encoder->icc_size; i++) {
             hyd_entropy_send_symbol(&icc_stream, icc_context(i, b1, b2), encoder->icc_data[i]);
             b2 = b1;
             b1 = encoder->icc_data[i];
         }
-        hyd_prefix_finalize_stream(&icc_stream, bw);
+        hyd_entropy_finalize_stream(&icc_stream, bw);
     }
 
     hyd_write_zero_pad(bw);
@@ -249,18 +453,21 @@ static void calculate_toc_perm(HYDEncoder *encoder, size_t toc_size, size_t *toc
         size_t raster_lfid = encoder->lfg_perm ? encoder->lfg_perm[sent_lfid] : sent_lfid;
         toc[idx++] = 1 + raster_lfid; // LFGroup
     }
-    for (size_t sent_lfid = 0; sent_lfid < encoder->lfg_per_frame; sent_lfid++) {
-        if (sent_lfid == 0)
-            toc[idx++] = 1 + encoder->lfg_per_frame; // HFGlobal
-        size_t raster_lfid = encoder->lfg_perm ? encoder->lfg_perm[sent_lfid] : sent_lfid;
-        const HYDLFGroup *lf_group = &encoder->lfg[raster_lfid];
-        const size_t gcountx = (lf_group->width + 255) >> 8;
-        const size_t gcounty = (lf_group->height + 255) >> 8;
-        const size_t gcount = gcountx * gcounty;
-        for (size_t g = 0; g < gcount; g++) {
-            size_t gy = (encoder->one_frame ? (lf_group->y << 3) : 0) + (g / gcountx);
-            size_t gx = (encoder->one_frame ? (lf_group->x << 3) : 0) + (g % gcountx);
-            toc[idx++] = 2 + encoder->lfg_per_frame + gy * frame_gx + gx;
+    toc[idx++] = 1 + encoder->lfg_per_frame; // HFGlobal
+    const size_t pass_groups = (toc_size - 2 - encoder->lfg_per_frame) / encoder->num_passes;
+    for (unsigned int pass = 0; pass < encoder->num_passes; pass++) {
+        for (size_t sent_lfid = 0; sent_lfid < encoder->lfg_per_frame; sent_lfid++) {
+            size_t raster_lfid = encoder->lfg_perm ? encoder->lfg_perm[sent_lfid] : sent_lfid;
+            const HYDLFGroup *lf_group = &encoder->lfg[raster_lfid];
+            const size_t gcountx = (lf_group->width + 255) >> 8;
+            const size_t gcounty = (lf_group->height + 255) >> 8;
+            const size_t gy0 = encoder->one_frame ? (lf_group->y << 3) : 0;
+            const size_t gx0 = encoder->one_frame ? (lf_group->x << 3) : 0;
+            for (size_t gy = gy0; gy < gy0 + gcounty; gy++) {
+                const size_t row = 2 + encoder->lfg_per_frame + pass * pass_groups + gy * frame_gx;
+                for (size_t gx = gx0; gx < gx0 + gcountx; gx++)
+                    toc[idx++] = row + gx;
+            }
         }
     }
     for (size_t j = 0; j < toc_size; j++)
@@ -271,14 +478,15 @@ static HYDStatusCode get_lehmer_sequence(HYDEncoder *encoder, size_t *toc_size,
     HYDStatusCode ret = HYD_OK;
     size_t toc_perm_array[64];
     size_t *toc_perm = NULL;
-    int32_t temp_array[64];
-    int32_t *temp = NULL;
-    const size_t frame_h = encoder->one_frame ? encoder->metadata.height : encoder->lfg->height;
-    const size_t frame_w = encoder->one_frame ? encoder->metadata.width : encoder->lfg->width;
+    size_t tree_array[64];
+    size_t *tree = NULL;
+    const size_t frame_h = encoder->one_frame ? coded_height(encoder) : encoder->lfg->height;
+    const size_t frame_w = encoder->one_frame ? coded_width(encoder) : encoder->lfg->width;
     const size_t frame_groups_y = (frame_h + 255) >> 8;
     const size_t frame_groups_x = (frame_w + 255) >> 8;
     const size_t num_frame_groups = frame_groups_x * frame_groups_y;
-    *toc_size = num_frame_groups > 1 ? 2 + num_frame_groups + encoder->lfg_per_frame : 1;
+    *toc_size = num_frame_groups > 1 || encoder->num_passes > 1 ?
+        2 + encoder->num_passes * num_frame_groups + encoder->lfg_per_frame : 1;
     if (*toc_size <= 1)
         return HYD_OK;
     ret = hyd_malloc_arraybuffer_p(*toc_size << 1, sizeof(*toc_perm), toc_perm_array,
@@ -288,12 +496,13 @@ static HYDStatusCode get_lehmer_sequence(HYDEncoder *encoder, size_t *toc_size,
 
     calculate_toc_perm(encoder, *toc_size, toc_perm, frame_groups_x);
 
-    ret = hyd_malloc_arraybuffer_p(*toc_size, sizeof(*temp), temp_array, sizeof(temp_array), &temp);
+    ret = hyd_malloc_arraybuffer_p(*toc_size + 1, sizeof(*tree), tree_array, sizeof(tree_array), &tree);
     if (ret < HYD_ERROR_START)
         goto end;
 
-    for (size_t i = 0; i < *toc_size; i++)
-        temp[i] = i;
+    /* Fenwick tree counting the entries not yet used, which is all of them to start */
+    for (size_t i = 1; i <= *toc_size; i++)
+        tree[i] = i & -i;
 
     size_t *lehmer;
     if (lehmer_init < *toc_size) {
@@ -307,25 +516,23 @@ static HYDStatusCode get_lehmer_sequence(HYDEncoder *encoder, size_t *toc_size,
         lehmer = *lehmer_p;
     }
     for (size_t i = 0; i < *toc_size; i++) {
+        /* the lehmer code is the number of unused entries before this one */
+        const size_t entry = toc_perm[*toc_size + i];
         size_t k = 0;
-        for (size_t j = 0; j < *toc_size; j++) {
-            if (temp[j] == toc_perm[*toc_size + i]) {
-                lehmer[i] = k;
-                temp[j] = -1;
-            } else if (temp[j] >= 0) {
-                k++;
-            }
-        }
+        for (size_t j = entry; j > 0; j &= j - 1)
+            k += tree[j];
+        lehmer[i] = k;
+        for (size_t j = entry + 1; j <= *toc_size; j += j & -j)
+            tree[j]--;
     }
 
 end:
     hyd_free_arraybuffer_p(toc_perm_array, &toc_perm);
-    hyd_free_arraybuffer_p(temp_array, &temp);
+    hyd_free_arraybuffer_p(tree_array, &tree);
     return ret;
 }
 
-static HYDStatusCode write_frame_header(HYDEncoder *encoder) {
-    HYDBitWriter *bw = &encoder->writer;
+static HYDStatusCode write_frame_header(HYDEncoder *encoder, HYDBitWriter *bw) {
     HYDStatusCode ret;
     HYDEntropyStream toc_stream = { 0 };
     size_t lehmer_array[64];
@@ -338,8 +545,8 @@ static HYDStatusCode write_frame_header(HYDEncoder *encoder) {
 
     int is_last = encoder->one_frame || encoder->last_tile;
     int have_crop = !encoder->one_frame &&
-        !(encoder->metadata.width <= encoder->lfg->width
-        && encoder->metadata.height <= encoder->lfg->height);
+        !(encoder->metadata.width <= encoder->lfg->input_width
+        && encoder->metadata.height <= encoder->lfg->input_height);
 
     /* all_default = 0 */
     hyd_write(bw, 0, 1);
@@ -347,26 +554,43 @@ static HYDStatusCode write_frame_header(HYDEncoder *encoder) {
     hyd_write(bw, is_last ? 0 : 3, 2);
     /* frame_encoding = VarDCT */
     hyd_write(bw, 0, 1);
-    /* flags = kSkipAdaptiveLFSmoothing */
-    hyd_write_u64(bw, 0x80);
+    /* flags = kSkipAdaptiveLFSmoothing, and kUseLFFrame with an LF frame */
+    hyd_write_u64(bw, encoder->metadata.lf_frame ? 0xA0 : 0x80);
+    /* upsampling = upsampling_shift:2, which frames using an LF frame don't have */
+    if (!encoder->metadata.lf_frame)
+        hyd_write(bw, encoder->upsampling_shift, 2);
     /*
-     * upsampling = 0:2
      * x_qm_scale = 3:3
      * b_qm_scale = 2:3
-     * num_passes = 0:2
+     * num_passes = num_passes - 1:2
      */
-    hyd_write(bw, 0x4C, 10);
+    hyd_write(bw, 0x13 | (encoder->num_passes - 1) << 6, 8);
+
+    if (encoder->num_passes > 1) {
+        /* num_ds = num_passes - 1:2 */
+        const unsigned int num_ds = encoder->num_passes - 1;
+        hyd_write(bw, num_ds, 2);
+        /* shift = 0:2, for each pass but the last */
+        hyd_write(bw, 0, 2 * (encoder->num_passes - 1));
+        /* downsample[i] = pass_downsample[i], which pass i is the last one needed for */
+        for (unsigned int i = 0; i < num_ds; i++)
+            hyd_write(bw, hyd_fllog2(pass_downsample[i]), 2);
+        /* last_pass[i] = i:2 */
+        for (unsigned int i = 0; i < num_ds; i++)
+            hyd_write(bw, i, 2);
+    }
 
     hyd_write_bool(bw, have_crop);
 
     if (have_crop) {
         // have_crop ==> !encoder->one_frame
-        size_t frame_w = encoder->lfg->tile_count_x << 8;
-        size_t frame_h = encoder->lfg->tile_count_y << 8;
+        // the crop is in image pixels, and the decoder divides it by the upsampling factor
+        size_t frame_w = encoder->lfg->tile_count_x << (8 + encoder->upsampling_shift);
+        size_t frame_h = encoder->lfg->tile_count_y << (8 + encoder->upsampling_shift);
         hyd_write_u32(bw, &frame_size_u32, hyd_pack_signed(encoder->lfg->x * frame_w));
         hyd_write_u32(bw, &frame_size_u32, hyd_pack_signed(encoder->lfg->y * frame_h));
-        hyd_write_u32(bw, &frame_size_u32, encoder->lfg->width);
-        hyd_write_u32(bw, &frame_size_u32, encoder->lfg->height);
+        hyd_write_u32(bw, &frame_size_u32, encoder->lfg->input_width);
+        hyd_write_u32(bw, &frame_size_u32, encoder->lfg->input_height);
     }
 
     /* blending_info.mode = kReplace */
@@ -410,6 +634,7 @@ static HYDStatusCode write_frame_header(HYDEncoder *encoder) {
         ret = hyd_entropy_init_stream(&toc_stream, 1 + toc_size, zerobuf, 8, 0, 0, 0, &encoder->error);
         if (ret < HYD_ERROR_START)
             goto end;
+        hyd_entropy_set_coding(&toc_stream, entropy_coding(encoder));
         ret = hyd_entropy_send_symbol(&toc_stream, 0, toc_size);
         if (ret < HYD_ERROR_START)
             goto end;
@@ -418,7 +643,7 @@ static HYDStatusCode write_frame_header(HYDEncoder *encoder) {
             if (ret < HYD_ERROR_START)
                 goto end;
         }
-        ret = hyd_prefix_finalize_stream(&toc_stream, bw);
+        ret = hyd_entropy_finalize_stream(&toc_stream, bw);
         if (ret < HYD_ERROR_START)
             goto end;
     } else {
@@ -434,15 +659,49 @@ end:
     return ret;
 }
 
+void hyd_set_distance(HYDEncoder *encoder, float distance) {
+    /*
+     * HF coefficients are quantized in steps of 65536 / (global_scale * hf_mult), and LF ones in steps
+     * of 65536 / (global_scale * quant_lf). The HF product goes with 1 / distance, and the LF one gets
+     * coarser more slowly. RDO quantization rounds where plain quantization truncates, so it gets
+     * coarser HF steps to keep about the same size.
+     */
+    const float hf_target = 163840.f / (encoder->rdo_quant ? 1.8f * distance : distance);
+    const float lf_target = 131072.f / (0.5f * (1.f + distance));
+    const float ratio = hf_target / lf_target;
+    /*
+     * quant_lf is picked first, so global_scale can put LF right on target. hf_mult is the base of
+     * the adaptive quantization field and must be at least 8, and out of the quant_lf that allow
+     * that, the one that puts hf_mult closest to a whole number keeps HF closest to its target.
+     */
+    uint32_t first = hyd_max((uint32_t)(8.f / ratio), (uint32_t)(lf_target / 73727.f) + 1);
+    if (first * ratio < 8.f)
+        first++;
+    uint32_t quant_lf = first;
+    float best_error = 1.f;
+    for (uint32_t q = first; q < first + 16; q++) {
+        const float hf_mult = q * ratio;
+        const float error = hyd_abs(hf_mult - (uint32_t)(hf_mult + 0.5f)) / hf_mult;
+        if (error < best_error) {
+            best_error = error;
+            quant_lf = q;
+        }
+    }
+    encoder->quant_lf = quant_lf;
+    encoder->global_scale = (uint32_t)(lf_target / quant_lf + 0.5f);
+    encoder->hf_mult = (uint16_t)(quant_lf * ratio + 0.5f);
+}
+
 HYDStatusCode hyd_populate_lf_group(HYDEncoder *encoder, HYDLFGroup **lf_group_ptr, uint32_t tile_x, uint32_t tile_y) {
     size_t w, h;
 
-    // check bounds
+    // check bounds, in input pixels
+    const int shift = encoder->upsampling_shift;
     if (encoder->one_frame) {
-        w = h = 2048;
+        w = h = 2048 << shift;
     } else {
-        h = encoder->lfg->tile_count_y << 8;
-        w = encoder->lfg->tile_count_x << 8;
+        h = encoder->lfg->tile_count_y << (8 + shift);
+        w = encoder->lfg->tile_count_x << (8 + shift);
     }
 
     if (tile_x >= hyd_ceil_div(encoder->metadata.width, w) || tile_y >= hyd_ceil_div(encoder->metadata.height, h)) {
@@ -459,8 +718,10 @@ HYDStatusCode hyd_populate_lf_group(HYDEncoder *encoder, HYDLFGroup **lf_group_p
         lf_group->tile_count_x = 8;
     }
 
-    lf_group->height = (tile_y + 1) * h > encoder->metadata.height ? encoder->metadata.height - tile_y * h : h;
-    lf_group->width = (tile_x + 1) * w > encoder->metadata.width ? encoder->metadata.width - tile_x * w : w;
+    lf_group->input_height = (tile_y + 1) * h > encoder->metadata.height ? encoder->metadata.height - tile_y * h : h;
+    lf_group->input_width = (tile_x + 1) * w > encoder->metadata.width ? encoder->metadata.width - tile_x * w : w;
+    lf_group->height = (lf_group->input_height + (1 << shift) - 1) >> shift;
+    lf_group->width = (lf_group->input_width + (1 << shift) - 1) >> shift;
     lf_group->varblock_height = (lf_group->height + 7) >> 3;
     lf_group->varblock_width = (lf_group->width + 7) >> 3;
     lf_group->stride = lf_group->varblock_width << 3;
@@ -480,8 +741,8 @@ HYDStatusCode hyd_send_tile_pre(HYDEncoder *encoder, uint32_t tile_x, uint32_t t
         return ret;
 
     encoder->last_tile = is_last < 0 ?
-        (tile_x + 1) * (lf_group->tile_count_x << 8) >= encoder->metadata.width &&
-        (tile_y + 1) * (lf_group->tile_count_y << 8) >= encoder->metadata.height
+        (tile_x + 1) * (lf_group->tile_count_x << 8) >= coded_width(encoder) &&
+        (tile_y + 1) * (lf_group->tile_count_y << 8) >= coded_height(encoder)
             : !!is_last;
 
     if (encoder->writer.overflow_state)
@@ -494,7 +755,7 @@ HYDStatusCode hyd_send_tile_pre(HYDEncoder *encoder, uint32_t tile_x, uint32_t t
     }
 
     if (!encoder->one_frame && !encoder->wrote_frame_header) {
-        ret = write_frame_header(encoder);
+        ret = write_frame_header(encoder, &encoder->writer);
         if (ret < HYD_ERROR_START)
             return ret;
     }
@@ -507,16 +768,44 @@ HYDStatusCode hyd_send_tile_pre(HYDEncoder *encoder, uint32_t tile_x, uint32_t t
     return HYD_OK;
 }
 
+/* the bits of the half-precision float nearest to v, which must be positive and in its normal range */
+static uint16_t f16_bits(float v) {
+    union { float f; uint32_t i; } u = { v };
+    /* rounds the 23-bit mantissa to 10 bits, carrying into the exponent, which is rebiased from 127 to 15 */
+    return ((u.i + 0x1000) >> 13) - (112 << 10);
+}
+
+static float f16_value(uint16_t bits) {
+    union { uint32_t i; float f; } u = { (uint32_t)(bits + (112 << 10)) << 13 };
+    return u.f;
+}
+
+/*
+ * What the LF of each channel is multiplied by before rounding. Modular frames, like the LF frame
+ * and the preview, signal these as 128 over a half-precision float, so for those they're picked to
+ * come out exactly. Decoders add Y back to B there before scaling it, so B has to share Y's scale.
+ */
+static void lf_quant_scales(const HYDEncoder *encoder, float scale[3], int modular) {
+    /* these are for globalScale = 32768 and quantLF = 4 */
+    const float lf_scale = (float)encoder->global_scale * encoder->quant_lf / 131072.f;
+    scale[0] = 8192.f * lf_scale;
+    scale[1] = 1024.f * lf_scale;
+    scale[2] = (modular ? 1024.f : 512.f) * lf_scale;
+    if (modular) {
+        for (int c = 0; c < 3; c++)
+            scale[c] = 128.f / f16_value(f16_bits(128.f / scale[c]));
+    }
+}
+
 static HYDStatusCode write_lf_global(HYDEncoder *encoder) {
     HYDBitWriter *bw = &encoder->working_writer;
 
     // LF channel quantization all_default
     hyd_write_bool(bw, 1);
 
-    // quantizer globalScale = 32768
-    hyd_write_u32(bw, &global_scale_table, 32768);
-    // quantizer quantLF = 4
-    hyd_write_u32(bw, &quant_lf_table, 4);
+    // quantizer
+    hyd_write_u32(bw, &global_scale_table, encoder->global_scale);
+    hyd_write_u32(bw, &quant_lf_table, encoder->quant_lf);
     // HF Block Context all_default
     hyd_write_bool(bw, 0);
     // lf and qf thresholds
@@ -536,11 +825,13 @@ static HYDStatusCode write_lf_global(HYDEncoder *encoder) {
     return hyd_write_bool(bw, 0);
 }
 
-static HYDStatusCode write_lf_group(HYDEncoder *encoder, HYDLFGroup *lf_group) {
+/*
+ * Write LF samples as a modular image with one gradient-predicted context, sample (x, y) of each
+ * channel being at base[y * y_step + x * x_step].
+ */
+static HYDStatusCode write_lf_samples(HYDEncoder *encoder, HYDBitWriter *bw, const XYBEntry *base,
+                                      size_t width, size_t height, size_t x_step, size_t y_step) {
     HYDStatusCode ret;
-    HYDBitWriter *bw = &encoder->working_writer;
-    // extra precision = 0
-    hyd_write(bw, 0, 2);
     // use global tree
     hyd_write_bool(bw, 0);
     // wp_params all_default
@@ -553,36 +844,40 @@ static HYDStatusCode write_lf_group(HYDEncoder *encoder, HYDLFGroup *lf_group) {
     ret = hyd_entropy_init_stream(&stream, hyd_array_size(lf_ma_tree), zerobuf, 6, 0, 0, 0, &encoder->error);
     if (ret < HYD_ERROR_START)
         return ret;
+    hyd_entropy_set_coding(&stream, entropy_coding(encoder));
     for (size_t i = 0; i < hyd_array_size(lf_ma_tree); i++) {
         ret = hyd_entropy_send_symbol(&stream, lf_ma_tree[i][0], lf_ma_tree[i][1]);
         if (ret < HYD_ERROR_START)
             return ret;
     }
 
-    ret = hyd_prefix_finalize_stream(&stream, bw);
+    ret = hyd_entropy_finalize_stream(&stream, bw);
     if (ret < HYD_ERROR_START)
         return ret;
 
-    size_t nb_blocks = lf_group->varblock_height * lf_group->varblock_width;
-    ret = hyd_entropy_init_stream(&stream, 3 * nb_blocks, zerobuf, 1, 1, 1 << 14, 1, &encoder->error);
-    if (ret < HYD_ERROR_START)
-        return ret;
-    ret = hyd_entropy_set_hybrid_config(&stream, 0, 0, 7, 1, 1);
-    if (ret < HYD_ERROR_START)
-        return ret;
-    const float shift[3] = {8192.f, 1024.f, 512.f};
+    const HYDStaticPreset *preset = static_preset(encoder);
+    if (preset) {
+        ret = init_static_stream(encoder, &stream, &preset->lf, bw);
+        if (ret < HYD_ERROR_START)
+            return ret;
+    } else {
+        ret = hyd_entropy_init_stream(&stream, 3 * width * height, zerobuf, 1, 1, 1 << 14, 1, &encoder->error);
+        if (ret < HYD_ERROR_START)
+            return ret;
+        ret = hyd_entropy_set_hybrid_config(&stream, 0, 0, 7, 1, 1);
+        if (ret < HYD_ERROR_START)
+            return ret;
+        hyd_entropy_set_lz77_search(&stream, width, lz77_chain_depth(encoder));
+        hyd_entropy_set_coding(&stream, entropy_coding(encoder));
+    }
     for (int i = 0; i < 3; i++) {
         const int c = i < 2 ? 1 - i : i;
-        for (size_t vy = 0; vy < lf_group->varblock_height; vy++) {
-            const size_t y = vy << 3;
-            const size_t row = lf_group->stride * y;
-            for (size_t vx = 0; vx < lf_group->varblock_width; vx++) {
-                const size_t x = vx << 3;
-                XYBEntry *xyb = &encoder->xyb[row + x];
-                xyb->xyb[c].i = xyb->xyb[c].f * shift[c];
-                const int32_t w = x > 0 ? xyb[-8].xyb[c].i : y > 0 ? xyb[-(lf_group->stride << 3)].xyb[c].i : 0;
-                const int32_t n = y > 0 ? xyb[-(lf_group->stride << 3)].xyb[c].i : w;
-                const int32_t nw = x > 0 && y > 0 ? xyb[-((lf_group->stride + 1) << 3)].xyb[c].i : w;
+        for (size_t y = 0; y < height; y++) {
+            for (size_t x = 0; x < width; x++) {
+                const XYBEntry *xyb = &base[y * y_step + x * x_step];
+                const int32_t w = x > 0 ? xyb[-x_step].xyb[c].i : y > 0 ? xyb[-y_step].xyb[c].i : 0;
+                const int32_t n = y > 0 ? xyb[-y_step].xyb[c].i : w;
+                const int32_t nw = x > 0 && y > 0 ? xyb[-(y_step + x_step)].xyb[c].i : w;
                 const int32_t vp = w + n - nw;
                 const int32_t min = hyd_min(w, n);
                 /* a ^ b ^ c, when c == a or c == b, gives the other one */
@@ -592,42 +887,244 @@ static HYDStatusCode write_lf_group(HYDEncoder *encoder, HYDLFGroup *lf_group) {
             }
         }
     }
-    ret = hyd_prefix_finalize_stream(&stream, bw);
-    if (ret < HYD_ERROR_START)
-        return ret;
-    hyd_write(bw, nb_blocks - 1, hyd_cllog2(nb_blocks));
+
+    return hyd_entropy_finalize_stream(&stream, bw);
+}
+
+static HYDStatusCode write_lf_group(HYDEncoder *encoder, HYDLFGroup *lf_group) {
+    HYDStatusCode ret;
+    HYDBitWriter *bw = &encoder->working_writer;
+    HYDEntropyStream stream;
+    float scale[3];
+    lf_quant_scales(encoder, scale, encoder->metadata.lf_frame);
+    for (size_t vy = 0; vy < lf_group->varblock_height; vy++) {
+        const size_t row = lf_group->stride * (vy << 3);
+        for (size_t vx = 0; vx < lf_group->varblock_width; vx++) {
+            XYBEntry *xyb = &encoder->xyb[row + (vx << 3)];
+            for (int c = 0; c < 3; c++)
+                xyb->xyb[c].i = xyb->xyb[c].f * scale[c];
+        }
+    }
+
+    if (encoder->metadata.lf_frame) {
+        /* the LF frame is written once the whole image is in, so this group's LF is kept for it */
+        const size_t lf_width = hyd_ceil_div(encoder->metadata.width, 8);
+        XYBEntry *lf = &encoder->lf_frame_samples[(lf_group->y << 8) * lf_width + (lf_group->x << 8)];
+        for (size_t vy = 0; vy < lf_group->varblock_height; vy++) {
+            const size_t row = lf_group->stride * (vy << 3);
+            for (size_t vx = 0; vx < lf_group->varblock_width; vx++)
+                lf[vy * lf_width + vx] = encoder->xyb[row + (vx << 3)];
+        }
+    } else {
+        // extra precision = 0
+        hyd_write(bw, 0, 2);
+        ret = write_lf_samples(encoder, bw, encoder->xyb, lf_group->varblock_width, lf_group->varblock_height,
+            8, lf_group->stride << 3);
+        if (ret < HYD_ERROR_START)
+            return ret;
+    }
+
+    size_t nb_blocks = lf_group->varblock_height * lf_group->varblock_width;
+    /* varblocks are placed in raster order at the first block no earlier one covers */
+    size_t nb_varblocks = 0;
+    for (size_t i = 0; i < nb_blocks; i++)
+        nb_varblocks += encoder->ac_strategy[i] != ACS_COVERED;
+    hyd_write(bw, nb_varblocks - 1, hyd_cllog2(nb_blocks));
     hyd_write(bw, 0x2, 4);
     ret = hyd_entropy_init_stream(&stream, 5, zerobuf, 6, 0, 0, 0, &encoder->error);
     if (ret < HYD_ERROR_START)
         return ret;
+    hyd_entropy_set_coding(&stream, entropy_coding(encoder));
     hyd_entropy_send_symbol(&stream, 1, 0);
     hyd_entropy_send_symbol(&stream, 2, 0);
     hyd_entropy_send_symbol(&stream, 3, 0);
     hyd_entropy_send_symbol(&stream, 4, 0);
     hyd_entropy_send_symbol(&stream, 5, 0);
-    ret = hyd_prefix_finalize_stream(&stream, bw);
+    ret = hyd_entropy_finalize_stream(&stream, bw);
     if (ret < HYD_ERROR_START)
         return ret;
     size_t cfl_height = (lf_group->varblock_height + 7) >> 3;
     size_t cfl_width = (lf_group->varblock_width + 7) >> 3;
-    size_t num_z_pre = 2 * cfl_width * cfl_height + nb_blocks;
-    size_t num_sym = num_z_pre + 2 * nb_blocks;
-    ret = hyd_entropy_init_stream(&stream, num_sym, zerobuf, 1, 0, 29, 1, &encoder->error);
+    size_t num_cfl = cfl_width * cfl_height;
+    size_t num_sym = 2 * num_cfl + 2 * nb_varblocks + nb_blocks;
+    /*
+     * static presets leave this one adaptive, as it's mostly long runs that LZ77 shrinks to nothing.
+     * CfL factors and HF multipliers take up to 8 bits, which tokenize below 36, so copies start there.
+     */
+    ret = hyd_entropy_init_stream(&stream, num_sym, zerobuf, 1, 0, 36, 1, &encoder->error);
     if (ret < HYD_ERROR_START)
         return ret;
-    for (size_t i = 0; i < num_z_pre; i++)
-        hyd_entropy_send_symbol(&stream, 0, 0);
-    for (size_t i = 0; i < nb_blocks; i++)
-        hyd_entropy_send_symbol(&stream, 0, (hf_mult - 1) * 2);
+    /* the block info channel is usually the widest, at nb_varblocks */
+    const size_t max_width = hyd_max3(nb_varblocks, cfl_width, lf_group->varblock_width);
+    hyd_entropy_set_lz77_search(&stream, max_width, lz77_chain_depth(encoder));
+    hyd_entropy_set_coding(&stream, entropy_coding(encoder));
+    for (int c = 0; c < 2; c++) {
+        for (size_t i = 0; i < num_cfl; i++)
+            hyd_entropy_send_symbol(&stream, 0, hyd_pack_signed(encoder->cfl_factors[c][i]));
+    }
+    for (size_t i = 0; i < nb_blocks; i++) {
+        if (encoder->ac_strategy[i] != ACS_COVERED)
+            hyd_entropy_send_symbol(&stream, 0, hyd_pack_signed(encoder->ac_strategy[i]));
+    }
+    for (size_t i = 0; i < nb_blocks; i++) {
+        if (encoder->ac_strategy[i] != ACS_COVERED)
+            hyd_entropy_send_symbol(&stream, 0, hyd_pack_signed(encoder->hf_mult_field[i] - 1));
+    }
     for (size_t i = 0; i < nb_blocks; i++)
         hyd_entropy_send_symbol(&stream, 0, 0);
-    ret = hyd_prefix_finalize_stream(&stream, bw);
+    ret = hyd_entropy_finalize_stream(&stream, bw);
     if (ret < HYD_ERROR_START)
         return ret;
 
     return bw->overflow_state;
 }
 
+/*
+ * Write quantized XYB samples as a modular frame: the LF of the whole image as an LF frame, for the
+ * frame after it to use in place of its own, or the preview. It's one group if it fits in 1024x1024,
+ * and otherwise, the channels are too big for the global section, so that's only their header, and
+ * each group codes its own piece of them.
+ */
+static HYDStatusCode write_modular_frame(HYDEncoder *encoder, HYDBitWriter *bw, const XYBEntry *samples,
+                                         size_t width, size_t height, int preview) {
+    HYDStatusCode ret;
+    HYDBitWriter body = { 0 };
+    size_t endpos_array[64];
+    size_t *endpos = NULL;
+    const size_t groups_x = (width + 1023) >> 10;
+    const size_t groups_y = (height + 1023) >> 10;
+    const size_t num_groups = groups_x * groups_y;
+    const size_t num_lf_groups = ((width + 8191) >> 13) * ((height + 8191) >> 13);
+    const size_t toc_size = num_groups > 1 ? 2 + num_lf_groups + num_groups : 1;
+    size_t section_count = 0;
+
+    ret = hyd_malloc_arraybuffer_p(toc_size, sizeof(*endpos), endpos_array, sizeof(endpos_array), &endpos);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    ret = hyd_init_paged_bit_writer(&body, &encoder->page_pool);
+    if (ret < HYD_ERROR_START)
+        goto end;
+
+    // LF channel quantization, as 128 times the step of each channel
+    hyd_write_bool(&body, 0);
+    float scale[3];
+    lf_quant_scales(encoder, scale, 1);
+    for (int c = 0; c < 3; c++)
+        hyd_write(&body, f16_bits(128.f / scale[c]), 16);
+    // GlobalModular have_global_tree
+    hyd_write_bool(&body, 0);
+    if (num_groups == 1) {
+        ret = write_lf_samples(encoder, &body, samples, width, height, 1, width);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        hyd_bitwriter_flush(&body);
+        endpos[section_count++] = hyd_bitwriter_tell(&body);
+    } else {
+        // use global tree
+        hyd_write_bool(&body, 0);
+        // wp_params all_default
+        hyd_write_bool(&body, 1);
+        // nb_transforms = 0
+        hyd_write(&body, 0, 2);
+        hyd_bitwriter_flush(&body);
+        /* the LF groups and HF global are empty, as there's nothing downsampled, and nothing VarDCT */
+        for (size_t i = 0; i < 2 + num_lf_groups; i++)
+            endpos[section_count++] = hyd_bitwriter_tell(&body);
+        for (size_t gy = 0; gy < groups_y; gy++) {
+            const size_t gh = hyd_min(height - (gy << 10), 1024);
+            for (size_t gx = 0; gx < groups_x; gx++) {
+                const size_t gw = hyd_min(width - (gx << 10), 1024);
+                const XYBEntry *base = &samples[(gy << 10) * width + (gx << 10)];
+                ret = write_lf_samples(encoder, &body, base, gw, gh, 1, width);
+                if (ret < HYD_ERROR_START)
+                    goto end;
+                hyd_bitwriter_flush(&body);
+                endpos[section_count++] = hyd_bitwriter_tell(&body);
+            }
+        }
+    }
+
+    hyd_write_zero_pad(bw);
+    /* all_default = 0 */
+    hyd_write_bool(bw, 0);
+    /* frame_type = kRegularFrame for the preview, and kLFFrame otherwise */
+    hyd_write(bw, !preview, 2);
+    /* frame_encoding = kModular */
+    hyd_write(bw, 1, 1);
+    /* flags = 0 */
+    hyd_write_u64(bw, 0);
+    if (preview) {
+        /*
+         * upsampling = 0:2
+         * group_size_shift = 3:2, for 1024x1024 groups
+         * num_passes = 0:2
+         * have_crop = 0:1
+         * blending_info.mode = kReplace:2
+         * is_last = 1:1, as the preview is a single frame
+         * name_len = 0:2
+         */
+        hyd_write(bw, 0x20C, 12);
+    } else {
+        /*
+         * upsampling = 0:2
+         * group_size_shift = 3:2, for 1024x1024 groups
+         * num_passes = 0:2
+         * lf_level = 0:2, which is 1, for 8x downsampling
+         * name_len = 0:2
+         */
+        hyd_write(bw, 0x0C, 10);
+    }
+    /* all_default = 0 */
+    hyd_write_bool(bw, 0);
+    /* gab = 0 */
+    hyd_write_bool(bw, 0);
+    /* epf_iters = 0 */
+    hyd_write(bw, 0, 2);
+    /* extensions = 0 */
+    hyd_write(bw, 0, 2);
+    /* extensions = 0 */
+    hyd_write(bw, 0, 2);
+    /* permuted toc = 0 */
+    hyd_write_bool(bw, 0);
+    hyd_write_zero_pad(bw);
+    size_t last_end_pos = 0;
+    for (size_t i = 0; i < section_count; i++) {
+        hyd_write_u32(bw, &toc_table, endpos[i] - last_end_pos);
+        last_end_pos = endpos[i];
+    }
+    hyd_write_zero_pad(bw);
+    ret = hyd_write_drain_to(bw, &body);
+
+end:
+    hyd_bitwriter_release(&body);
+    hyd_free_arraybuffer_p(endpos_array, &endpos);
+    return ret;
+}
+
+/*
+ * Write the preview, which is the average of the coded pixels under each of its pixels,
+ * quantized like the LF of an LF frame.
+ */
+static HYDStatusCode write_preview(HYDEncoder *encoder, HYDBitWriter *bw) {
+    const size_t coded_w = coded_width(encoder);
+    const size_t coded_h = coded_height(encoder);
+    const int shift = encoder->preview_shift;
+    float scale[3];
+    lf_quant_scales(encoder, scale, 1);
+    for (size_t y = 0; y < encoder->preview_height; y++) {
+        const size_t rows = hyd_min(coded_h - (y << shift), (size_t)1 << shift);
+        for (size_t x = 0; x < encoder->preview_width; x++) {
+            const size_t cols = hyd_min(coded_w - (x << shift), (size_t)1 << shift);
+            const float area = (float)(rows * cols);
+            XYBEntry *xyb = &encoder->preview_samples[y * encoder->preview_width + x];
+            for (int c = 0; c < 3; c++)
+                xyb->xyb[c].i = xyb->xyb[c].f * scale[c] / area;
+        }
+    }
+    return write_modular_frame(encoder, bw, encoder->preview_samples, encoder->preview_width,
+        encoder->preview_height, 1);
+}
+
 static void forward_dct(HYDEncoder *encoder, HYDLFGroup *lf_group) {
     float scratchblock[2][8][8];
     for (size_t c = 0; c < 3; c++) {
@@ -667,122 +1164,781 @@ static void forward_dct(HYDEncoder *encoder, HYDLFGroup *lf_group) {
     }
 }
 
-static uint8_t get_predicted_non_zeroes(uint8_vec3 *nz, size_t y, size_t x, size_t w, int c) {
-    if (!x && !y)
-        return 32;
-    if (!x)
-        return nz[(y - 1) * w].v[c];
-    if (!y)
-        return nz[x - 1].v[c];
-    return (nz[(y - 1) * w + x].v[c] + (uint32_t)nz[(y * w) + (x - 1)].v[c] + 1) >> 1;
+void hyd_transform_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t tile_y) {
+    const size_t lfid = encoder->one_frame ? tile_y * encoder->lfg_count_x + tile_x : 0;
+    forward_dct(encoder, &encoder->lfg[lfid]);
 }
 
-static inline size_t get_non_zero_context(size_t predicted) {
-    if (predicted < 8)
-        return predicted;
-    if (predicted > 64)
-        predicted = 64;
-
-    return 4 + (predicted >> 1);
-}
+/*
+ * Scan coefficients from most to least often non-zero, so each block runs out of them sooner.
+ * It's only worth sending if that scans at least an eighth fewer of them in lf_group.
+ */
+static void compute_coeff_order(HYDEncoder *encoder, const HYDLFGroup *lf_group, const uint32_t coeff_hits[3][64]) {
+    uint8_t rank[3][64];
+    for (int c = 0; c < 3; c++) {
+        uint8_t *order = encoder->coeff_order[c];
+        order[0] = 0;
+        /* insertion sort, so ties stay in natural order */
+        for (int j = 1; j < 64; j++) {
+            int k = j;
+            for (; k > 1 && coeff_hits[c][order[k - 1]] < coeff_hits[c][j]; k--)
+                order[k] = order[k - 1];
+            order[k] = j;
+        }
+        for (int k = 0; k < 64; k++)
+            rank[c][order[k]] = k;
+    }
 
-static HYDStatusCode initialize_hf_coeffs(HYDEncoder *encoder, HYDEntropyStream *stream, HYDLFGroup *lf_group,
-                                          size_t num_non_zeroes, uint8_vec3 *non_zeroes, size_t lfid) {
-    HYDStatusCode ret;
-    size_t preset = lfid / hyd_ceil_div(encoder->lfg_per_frame, 256); // this is always < 256
-    HFBarrier *symbol_count = encoder->hf_stream_barrier;
-    size_t gindex = encoder->groups_encoded;
-    for (size_t gy = 0; gy < lf_group->tile_count_y; gy++) {
-        if (gy << 8 >= lf_group->height)
-            break;
-        const size_t gh = (gy + 1) << 8 > lf_group->height ?
-            lf_group->height - (gy << 8) : 256;
-        const size_t gbh = (gh + 7) >> 3;
-        for (size_t gx = 0; gx < lf_group->tile_count_x; gx++) {
-            if (gx << 8 >= lf_group->width)
-                break;
-            const size_t gw = (gx + 1) << 8 > lf_group->width ?
-                lf_group->width - (gx << 8) : 256;
-            const size_t gbw = (gw + 7) >> 3;
-            for (size_t by = 0; by < gbh; by++) {
-                const size_t vy = (by << 3) + (gy << 8);
-                for (size_t bx = 0; bx < gbw; bx++) {
-                    const size_t vx = (bx << 3) + (gx << 8);
-                    for (unsigned int i = 0; i < 3; i++) {
-                        unsigned int c = i < 2 ? 1 - i : i;
-                        uint8_t predicted = get_predicted_non_zeroes(non_zeroes, by, bx, gbw, c);
-                        size_t block_context = i;
-                        size_t non_zero_context = 1485 * preset + 3 * get_non_zero_context(predicted) + block_context;
-                        uint32_t non_zero_count = non_zeroes[by * gbw + bx].v[c];
-                        ret = hyd_entropy_send_symbol(stream, non_zero_context, non_zero_count);
-                        symbol_count[gindex].barrier_index++;
-                        if (ret < HYD_ERROR_START)
-                            return ret;
-                        if (!non_zero_count)
-                            continue;
-                        //size_t hist_context = 458 * block_context + 555;
-                        size_t hist_context = 1485 * preset + 458 * block_context + 111;
-                        for (int k = 0; k < 63; k++) {
-                            const IntPos pos = natural_order[k + 1];
-                            const IntPos prev_pos = natural_order[k];
-                            size_t prev_pos_s = (vy + prev_pos.y) * lf_group->stride + (vx + prev_pos.x);
-                            size_t pos_s = (vy + pos.y) * lf_group->stride + (vx + pos.x);
-                            unsigned int prev = k ? !!encoder->xyb[prev_pos_s].xyb[c].i : non_zero_count <= 4;
-                            size_t coeff_context = hist_context + prev +
-                                ((coeff_num_non_zero_context[non_zero_count] + coeff_freq_context[k + 1]) << 1);
-                            uint32_t value = hyd_pack_signed(encoder->xyb[pos_s].xyb[c].i);
-                            ret = hyd_entropy_send_symbol(stream, coeff_context, value);
-                            symbol_count[gindex].barrier_index++;
-                            if (ret < HYD_ERROR_START)
-                                return ret;
-                            if (value && !--non_zero_count)
-                                break;
-                        }
-                    }
+    size_t natural_scan = 0, custom_scan = 0;
+    const size_t stride = lf_group->varblock_width << 3;
+    for (size_t vy = 0; vy < lf_group->varblock_height << 3; vy += 8) {
+        for (size_t vx = 0; vx < stride; vx += 8) {
+            if (encoder->ac_strategy[(vy >> 3) * lf_group->varblock_width + (vx >> 3)] != ACS_DCT8)
+                continue;
+            for (int c = 0; c < 3; c++) {
+                size_t natural_last = 0, custom_last = 0;
+                for (int j = 1; j < 64; j++) {
+                    if (!encoder->xyb[(vy + natural_order[j].y) * stride + vx + natural_order[j].x].xyb[c].i)
+                        continue;
+                    natural_last = j;
+                    custom_last = hyd_max(custom_last, rank[c][j]);
                 }
+                natural_scan += natural_last;
+                custom_scan += custom_last;
             }
-            non_zeroes += 1 << 10;
-            symbol_count[gindex++].preset = preset;
         }
     }
 
-    return encoder->working_writer.overflow_state;
+    /* the orders themselves take up to a few hundred bytes, hence the floor */
+    encoder->custom_coeff_order = custom_scan + hyd_max(natural_scan >> 3, 2048) < natural_scan;
+    if (!encoder->custom_coeff_order) {
+        for (int c = 0; c < 3; c++) {
+            for (int k = 0; k < 64; k++)
+                encoder->coeff_order[c][k] = k;
+        }
+    }
 }
 
-HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t tile_y) {
-    uint8_vec3 *non_zeroes = NULL;
-    uint8_t *hf_cluster_map = NULL;
-    HYDStatusCode ret = HYD_OK;
-    int need_buffer_init = !encoder->working_writer.buffer_len || !encoder->one_frame;
-    if (need_buffer_init) {
-        ret = hyd_init_bit_writer(&encoder->working_writer, encoder->working_writer.buffer,
-                                   encoder->working_writer.buffer_len, 0, 0);
-        encoder->copy_pos = 0;
-    }
+static HYDStatusCode write_coeff_orders(HYDEncoder *encoder, HYDBitWriter *bw) {
+    HYDStatusCode ret;
+    HYDEntropyStream stream;
+    uint32_t lehmer[64];
+
+    /* bit 0 of used_orders is DCT8, and the larger transforms keep their natural order */
+    hyd_write_u32(bw, &used_orders_table, encoder->custom_coeff_order);
+    if (!encoder->custom_coeff_order)
+        return bw->overflow_state;
 
+    ret = hyd_entropy_init_stream(&stream, 3 * 64, zerobuf, 8, 0, 0, 0, &encoder->error);
     if (ret < HYD_ERROR_START)
-        goto end;
+        return ret;
+    hyd_entropy_set_coding(&stream, entropy_coding(encoder));
+    for (int c = 0; c < 3; c++) {
+        const uint8_t *order = encoder->coeff_order[c];
+        /* the DC coefficient always comes first, so it's skipped */
+        size_t end = 1;
+        for (int i = 1; i < 64; i++) {
+            /* the lehmer code is the number of later entries that are smaller */
+            lehmer[i] = 0;
+            for (int j = i + 1; j < 64; j++)
+                lehmer[i] += order[j] < order[i];
+            if (lehmer[i])
+                end = i + 1;
+        }
+        ret = hyd_entropy_send_symbol(&stream, 0, end - 1);
+        if (ret < HYD_ERROR_START)
+            goto fail;
+        for (size_t i = 1; i < end; i++) {
+            ret = hyd_entropy_send_symbol(&stream, 0, lehmer[i]);
+            if (ret < HYD_ERROR_START)
+                goto fail;
+        }
+    }
 
-    const size_t lfid = encoder->one_frame ? tile_y * encoder->lfg_count_x + tile_x : 0;
-    HYDLFGroup *lf_group = &encoder->lfg[lfid];
-    forward_dct(encoder, lf_group);
-    size_t num_frame_groups;
-    size_t frame_h = encoder->one_frame ? encoder->metadata.height : encoder->lfg->height;
-    size_t frame_w = encoder->one_frame ? encoder->metadata.width : encoder->lfg->width;
-    size_t frame_groups_y = (frame_h + 255) >> 8;
-    size_t frame_groups_x = (frame_w + 255) >> 8;
-    encoder->num_hf_coeff_bw = num_frame_groups = frame_groups_x * frame_groups_y;
+    return hyd_entropy_finalize_stream(&stream, bw);
 
-    const size_t num_groups = ((lf_group->width + 255) >> 8) * ((lf_group->height + 255) >> 8);
-    non_zeroes = calloc(num_groups << 10, sizeof(*non_zeroes));
-    if (!non_zeroes) {
-        ret = HYD_NOMEM;
-        goto end;
+fail:
+    hyd_entropy_stream_destroy(&stream);
+    return ret;
+}
+
+/* AC energy of a block's Y channel, in units of the base quantizer step */
+static float block_activity(const HYDEncoder *encoder, const HYDLFGroup *lf_group, size_t vx, size_t vy) {
+    float activity = 0.f;
+    for (int j = 1; j < 64; j++) {
+        const size_t pos = (vy + natural_order[j].y) * lf_group->stride + vx + natural_order[j].x;
+        activity += hyd_abs(encoder->xyb[pos].xyb[1].f) * hf_quant_weights[1][j];
     }
+    return activity;
+}
+
+/*
+ * Texture hides quantization error better than flat areas do, so blocks busier than the LF group's
+ * average get a smaller HF multiplier, down to half of the base one. A block is only as busy as its
+ * calmest neighbor, so edges next to flat areas, like text, keep the full multiplier.
+ */
+static HYDStatusCode compute_hf_mult_field(HYDEncoder *encoder, const HYDLFGroup *lf_group) {
+    const size_t bw = lf_group->varblock_width;
+    const size_t bh = lf_group->varblock_height;
+    const float base = encoder->hf_mult;
+    const uint8_t min_mult = (encoder->hf_mult + 1) >> 1;
+    float *activity = hyd_malloc_array(bw * bh, sizeof(float));
+    if (!activity)
+        return HYD_NOMEM;
+    float total = 0.f;
+    for (size_t by = 0; by < bh; by++) {
+        for (size_t bx = 0; bx < bw; bx++) {
+            activity[by * bw + bx] = block_activity(encoder, lf_group, bx << 3, by << 3);
+            total += activity[by * bw + bx];
+        }
+    }
+    const float mean = total / (bw * bh);
+    for (size_t by = 0; by < bh; by++) {
+        for (size_t bx = 0; bx < bw; bx++) {
+            const float *a = &activity[by * bw + bx];
+            float masking = *a;
+            if (bx > 0)
+                masking = hyd_min(masking, a[-1]);
+            if (bx + 1 < bw)
+                masking = hyd_min(masking, a[1]);
+            if (by > 0)
+                masking = hyd_min(masking, a[-(ptrdiff_t)bw]);
+            if (by + 1 < bh)
+                masking = hyd_min(masking, a[bw]);
+            uint8_t mult = encoder->hf_mult;
+            if (masking > mean)
+                mult = hyd_max(min_mult, (uint8_t)(base * 2.f * mean / (mean + masking) + 0.5f));
+            encoder->hf_mult_field[by * bw + bx] = mult;
+        }
+    }
+    hyd_freep(&activity);
+
+    return HYD_OK;
+}
+
+/*
+ * The natural order of a square DCT is its LLF coefficients, the ones that come from the LF of its
+ * blocks, in raster order, and then the rest in zigzag order. Each block's corner holds that block's
+ * LF value, so the coefficients that land on one go in the LLF slots instead, as those aren't coded.
+ */
+static void init_varblock_layout(VarblockLayout *layout, int log_side, size_t stride) {
+    const size_t side = 1 << log_side;
+    const size_t width = side << 3;
+    layout->side = side;
+    layout->size = width * width;
+    layout->weights = log_side == 2 ? hyd_dct32_weights[0] : log_side ? hyd_dct16_weights[0] : hf_quant_weights[0];
+    uint8_t dct8_index[64];
+    for (int j = 0; j < 64; j++)
+        dct8_index[(natural_order[j].y << 3) + natural_order[j].x] = j;
+    size_t k = side * side;
+    for (size_t d = 0; d < 2 * width - 1; d++) {
+        const size_t lo = d < width ? 0 : d - width + 1;
+        const size_t hi = d < width ? d : width - 1;
+        for (size_t t = lo; t <= hi; t++) {
+            /* x counts up along even diagonals and down along odd ones */
+            const size_t x = d & 1 ? hi + lo - t : t;
+            const size_t y = d - x;
+            const size_t n = x < side && y < side ? y * side + x : k++;
+            layout->raster[n] = y * width + x;
+            layout->offsets[n] = (x & 7) || (y & 7) ? y * stride + x : (y >> 3) * stride + (x >> 3);
+            layout->band[n] = hyd_max(x, y) >> log_side;
+            /* a coefficient's error spreads over side * side blocks, at the frequency it's rounded to */
+            const size_t x8 = hyd_min((x + (side >> 1)) >> log_side, 7);
+            const size_t y8 = hyd_min((y + (side >> 1)) >> log_side, 7);
+            for (int c = 0; c < 3; c++) {
+                const float w8 = hf_quant_weights[c][dct8_index[(y8 << 3) + x8]];
+                const float w = layout->weights[c * layout->size + n];
+                layout->zeroed_error[c][n] = side * side * w8 * w8;
+                layout->step_error[c][n] = side * side * w8 * w8 / (w * w);
+            }
+        }
+    }
+}
+
+static inline const VarblockLayout *varblock_layout(const VarblockLayout *layouts, uint8_t acs) {
+    return &layouts[acs == ACS_DCT32 ? 2 : acs == ACS_DCT16];
+}
+
+/* cos(pi * (2i + 1) * k / 2n), for n up to 32 */
+static inline float dct_basis(size_t n, size_t i, size_t k) {
+    return dct_cos[((2 * i + 1) * k * (32 / n)) & 127];
+}
+
+/* what each coefficient of an n-point DCT, as forward_dct scales them, adds to sample i */
+static inline float idct_basis(size_t n, size_t i, size_t k) {
+    return k ? 1.41421356f * dct_basis(n, i, k) : 1.f;
+}
+
+/* n x n DCT of pixels, scaled like forward_dct, into coeffs[y * n + x] with x the vertical frequency */
+static void dct_square(float *coeffs, float *tmp, const float *pixels, size_t pixel_stride, size_t n) {
+    for (size_t y = 0; y < n; y++) {
+        for (size_t k = 0; k < n; k++) {
+            float sum = 0.f;
+            for (size_t x = 0; x < n; x++)
+                sum += pixels[y * pixel_stride + x] * dct_basis(n, x, k);
+            tmp[y * n + k] = sum * (k ? 1.41421356f : 1.f) / n;
+        }
+    }
+    for (size_t j = 0; j < n; j++) {
+        for (size_t k = 0; k < n; k++) {
+            float sum = 0.f;
+            for (size_t y = 0; y < n; y++)
+                sum += tmp[y * n + j] * dct_basis(n, y, k);
+            coeffs[j * n + k] = sum * (k ? 1.41421356f : 1.f) / n;
+        }
+    }
+}
+
+/* pixels back from the forward_dct output of one block */
+static void idct8(float *pixels, size_t pixel_stride, const XYBEntry *xyb, size_t stride, int c) {
+    float tmp[8][8];
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t i = 0; i < 8; i++) {
+            float sum = 0.f;
+            for (size_t k = 0; k < 8; k++)
+                sum += xyb[y * stride + k].xyb[c].f * idct_basis(8, i, k);
+            tmp[y][i] = sum;
+        }
+    }
+    for (size_t y = 0; y < 8; y++) {
+        for (size_t x = 0; x < 8; x++) {
+            float sum = 0.f;
+            for (size_t k = 0; k < 8; k++)
+                sum += tmp[k][y] * idct_basis(8, x, k);
+            pixels[y * pixel_stride + x] = sum;
+        }
+    }
+}
+
+/*
+ * Rough cost of channel c of a varblock: bits for the coefficients that survive quantization, plus
+ * the error of all of them. The larger DCTs quantize chroma more coarsely than DCT8 does, which
+ * this has to see, or they win on edges they shouldn't.
+ */
+static float varblock_cost(const float *coeffs, const VarblockLayout *layout, int c, float hf_scale) {
+    const float *weights = layout->weights + c * layout->size;
+    const size_t covered = layout->side * layout->side;
+    float bits = 0.f, zeroed = 0.f, kept = 0.f;
+    size_t count = 0, last = covered;
+    for (size_t k = covered; k < layout->size; k++) {
+        const float coeff = coeffs[layout->raster[k]];
+        const float r = hyd_abs(coeff) * weights[k] * hf_scale;
+        if (r < 1.f) {
+            zeroed += coeff * coeff * layout->zeroed_error[c][k];
+        } else {
+            bits += ACS_BITS_PER_COEFF + 2.f * hyd_log2f(r);
+            kept += layout->step_error[c][k];
+            count++;
+            last = k + 1;
+        }
+    }
+    /* the zeros before the last coefficient that survives get coded too */
+    bits += ACS_BITS_PER_ZERO * (last - covered - count);
+    /* rounding leaves about a quarter of a squared step */
+    return bits + ACS_BITS_PER_ERROR * (zeroed * hf_scale * hf_scale + 0.25f * kept);
+}
+
+/* factor the decoder divides LLF coefficient k of an n x n DCT by, when it computes them from LF */
+static inline float llf_scale(size_t n, size_t k) {
+    return dct_cos[k * 32 / n] * dct_cos[k * 64 / n] * dct_cos[k * 128 / n];
+}
+
+/*
+ * Put a larger varblock at block (bx, by), with coeffs from dct_square, and give its blocks the LF
+ * values that the decoder turns back into its LLF coefficients. It takes the largest HF multiplier
+ * of the blocks it covers, so none of them end up quantized more coarsely.
+ */
+static void store_varblock(HYDEncoder *encoder, const HYDLFGroup *lf_group, const VarblockLayout *layout,
+        uint8_t acs, size_t bx, size_t by, const float *coeffs) {
+    const size_t side = layout->side;
+    const size_t width = side << 3;
+    const size_t bw = lf_group->varblock_width;
+    uint8_t mult = 0;
+    for (size_t y = by; y < by + side; y++) {
+        for (size_t x = bx; x < bx + side; x++) {
+            mult = hyd_max(mult, encoder->hf_mult_field[y * bw + x]);
+            encoder->ac_strategy[y * bw + x] = ACS_COVERED;
+        }
+    }
+    for (size_t y = by; y < by + side; y++) {
+        for (size_t x = bx; x < bx + side; x++)
+            encoder->hf_mult_field[y * bw + x] = mult;
+    }
+    encoder->ac_strategy[by * bw + bx] = acs;
+
+    XYBEntry *xyb = &encoder->xyb[(by << 3) * lf_group->stride + (bx << 3)];
+    for (int c = 0; c < 3; c++) {
+        const float *co = coeffs + c * layout->size;
+        for (size_t k = side * side; k < layout->size; k++)
+            xyb[layout->offsets[k]].xyb[c].f = co[layout->raster[k]];
+        for (size_t y = 0; y < side; y++) {
+            for (size_t x = 0; x < side; x++) {
+                float lf = 0.f;
+                for (size_t ky = 0; ky < side; ky++) {
+                    for (size_t kx = 0; kx < side; kx++)
+                        lf += co[ky * width + kx] * llf_scale(width, kx) * llf_scale(width, ky)
+                            * idct_basis(side, y, kx) * idct_basis(side, x, ky);
+                }
+                xyb[(y << 3) * lf_group->stride + (x << 3)].xyb[c].f = lf;
+            }
+        }
+    }
+}
+
+/*
+ * Merge 2x2 blocks into a DCT16, and at effort 5, 4x4 blocks into a DCT32, wherever that looks
+ * cheaper by varblock_cost. They're tried on each aligned 32x32 region, so none of them cross a
+ * group boundary. This wins on smooth areas, where a larger transform leaves fewer coefficients.
+ */
+static HYDStatusCode compute_ac_strategy(HYDEncoder *encoder, const HYDLFGroup *lf_group,
+        const VarblockLayout *layouts) {
+    const size_t bw = lf_group->varblock_width;
+    const size_t bh = lf_group->varblock_height;
+    const size_t stride = lf_group->stride;
+    ACSScratch *scratch = malloc(sizeof(ACSScratch));
+    if (!scratch)
+        return HYD_NOMEM;
+    for (size_t ry = 0; ry + 1 < bh; ry += 4) {
+        const size_t nby = hyd_min(bh - ry, 4);
+        for (size_t rx = 0; rx + 1 < bw; rx += 4) {
+            const size_t nbx = hyd_min(bw - rx, 4);
+            for (size_t y = 0; y < nby; y++) {
+                for (size_t x = 0; x < nbx; x++) {
+                    const XYBEntry *xyb = &encoder->xyb[((ry + y) << 3) * stride + ((rx + x) << 3)];
+                    for (int c = 0; c < 3; c++)
+                        idct8(&scratch->pixels[c][(y << 8) + (x << 3)], 32, xyb, stride, c);
+                }
+            }
+            float cost8[4] = { 0 }, cost16[4], cost32 = 0.f;
+            int quads = 0;
+            for (int q = 0; q < 4; q++) {
+                const size_t qy = (q >> 1) << 1, qx = (q & 1) << 1;
+                if (qy + 2 > nby || qx + 2 > nbx)
+                    continue;
+                quads++;
+                uint8_t mult = 0;
+                for (size_t y = ry + qy; y < ry + qy + 2; y++) {
+                    for (size_t x = rx + qx; x < rx + qx + 2; x++) {
+                        const uint8_t m = encoder->hf_mult_field[y * bw + x];
+                        mult = hyd_max(mult, m);
+                        const XYBEntry *xyb = &encoder->xyb[(y << 3) * stride + (x << 3)];
+                        for (int c = 0; c < 3; c++) {
+                            for (size_t i = 0; i < 64; i++)
+                                scratch->dct8[i] = xyb[(i >> 3) * stride + (i & 7)].xyb[c].f;
+                            cost8[q] += varblock_cost(scratch->dct8, &layouts[0], c,
+                                (float)m * encoder->global_scale / 32768.f);
+                        }
+                    }
+                }
+                cost16[q] = 0.f;
+                for (int c = 0; c < 3; c++) {
+                    const float *pixels = &scratch->pixels[c][(qy << 8) + (qx << 3)];
+                    dct_square(scratch->dct16[q][c], scratch->tmp, pixels, 32, 16);
+                    cost16[q] += varblock_cost(scratch->dct16[q][c], &layouts[1], c,
+                        (float)mult * encoder->global_scale / 32768.f);
+                }
+                cost32 += hyd_min(cost8[q], cost16[q]);
+            }
+            if (encoder->effort >= 5 && quads == 4) {
+                uint8_t mult = 0;
+                for (size_t y = ry; y < ry + 4; y++) {
+                    for (size_t x = rx; x < rx + 4; x++)
+                        mult = hyd_max(mult, encoder->hf_mult_field[y * bw + x]);
+                }
+                float cost = 0.f;
+                for (int c = 0; c < 3; c++) {
+                    dct_square(scratch->dct32[c], scratch->tmp, scratch->pixels[c], 32, 32);
+                    cost += varblock_cost(scratch->dct32[c], &layouts[2], c,
+                        (float)mult * encoder->global_scale / 32768.f);
+                }
+                if (cost < cost32) {
+                    store_varblock(encoder, lf_group, &layouts[2], ACS_DCT32, rx, ry, scratch->dct32[0]);
+                    continue;
+                }
+            }
+            for (int q = 0; q < 4; q++) {
+                const size_t qy = (q >> 1) << 1, qx = (q & 1) << 1;
+                if (qy + 2 <= nby && qx + 2 <= nbx && cost16[q] < cost8[q])
+                    store_varblock(encoder, lf_group, &layouts[1], ACS_DCT16, rx + qx, ry + qy,
+                        scratch->dct16[q][0]);
+            }
+        }
+    }
+    hyd_freep(&scratch);
+
+    return HYD_OK;
+}
+
+/*
+ * Cost of predicting channel c of a 64x64 tile from Y with the given factor, in squared quant steps.
+ * Residuals that survive quantization cost a flat 4, and ones that don't cost their full error, so
+ * the factor has to leave most of the tile better off, not just its strongest coefficients.
+ * If ls isn't NULL, it's set to the factor that a plain least-squares fit would pick.
+ */
+static float cfl_tile_cost(const HYDEncoder *encoder, const HYDLFGroup *lf_group, size_t tx, size_t ty,
+        int c, int factor, float *ls) {
+    const float k = factor / 84.f;
+    float cost = 0.f, xy = 0.f, yy = 0.f;
+    const size_t bh = hyd_min(lf_group->varblock_height, (ty + 1) << 3);
+    const size_t bw = hyd_min(lf_group->varblock_width, (tx + 1) << 3);
+    for (size_t by = ty << 3; by < bh; by++) {
+        for (size_t bx = tx << 3; bx < bw; bx++) {
+            const float hf_scale = (float)encoder->hf_mult_field[by * lf_group->varblock_width + bx]
+                * encoder->global_scale / 32768.f;
+            for (int j = 1; j < 64; j++) {
+                const size_t pos = ((by << 3) + natural_order[j].y) * lf_group->stride
+                    + (bx << 3) + natural_order[j].x;
+                const XYBEntry *xyb = &encoder->xyb[pos];
+                /* what the decoder gets back for Y, as that's what it predicts from */
+                const float wy = hf_quant_weights[1][j] * hf_scale;
+                const int32_t qy = (int32_t)(xyb->xyb[1].f * wy);
+                const float y = hyd_abs(qy) < 2 ? 0.f : qy / wy;
+                const float w = hf_quant_weights[c][j] * hf_scale;
+                const float r = (xyb->xyb[c].f - k * y) * w;
+                cost += hyd_min(r * r, 4.f);
+                xy += xyb->xyb[c].f * y * w * w;
+                yy += y * y * w * w;
+            }
+        }
+    }
+    if (ls)
+        *ls = yy > 0.f ? 84.f * xy / yy : 0.f;
+    return cost;
+}
+
+/*
+ * XFromY and BFromY of each 64x64 tile, in units of 1/84, the default colour_factor. The least-squares
+ * factor overshoots on tiles where a few strong edges correlate and the rest don't, so it's only a
+ * starting point, and smaller factors down to zero get a look too.
+ */
+static void compute_cfl_factors(HYDEncoder *encoder, const HYDLFGroup *lf_group) {
+    const size_t cfl_width = (lf_group->varblock_width + 7) >> 3;
+    const size_t cfl_height = (lf_group->varblock_height + 7) >> 3;
+    for (size_t ty = 0; ty < cfl_height; ty++) {
+        for (size_t tx = 0; tx < cfl_width; tx++) {
+            for (int c = 0; c < 2; c++) {
+                float ls;
+                int best = 0;
+                float best_cost = cfl_tile_cost(encoder, lf_group, tx, ty, 2 * c, 0, &ls);
+                for (int n = 4; n > 0; n--) {
+                    const float f = ls * n * 0.25f;
+                    const int factor = hyd_clamp((int)(f + (f < 0.f ? -0.5f : 0.5f)), -128, 127);
+                    if (!factor || factor == best)
+                        continue;
+                    const float cost = cfl_tile_cost(encoder, lf_group, tx, ty, 2 * c, factor, NULL);
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best = factor;
+                    }
+                }
+                encoder->cfl_factors[c][ty * cfl_width + tx] = best;
+            }
+        }
+    }
+}
+
+static uint8_t get_predicted_non_zeroes(uint16_vec3 *nz, size_t y, size_t x, size_t w, int c) {
+    if (!x && !y)
+        return 32;
+    if (!x)
+        return nz[(y - 1) * w].v[c];
+    if (!y)
+        return nz[x - 1].v[c];
+    return (nz[(y - 1) * w + x].v[c] + (uint32_t)nz[(y * w) + (x - 1)].v[c] + 1) >> 1;
+}
+
+static inline size_t get_non_zero_context(size_t predicted) {
+    if (predicted < 8)
+        return predicted;
+    if (predicted > 64)
+        predicted = 64;
+
+    return 4 + (predicted >> 1);
+}
+
+/* what the decoder's default dequantization bias turns a quantized magnitude back into */
+static inline float dequantized(uint32_t q) {
+    return q == 1 ? 0.95f : q - 0.145f / q;
+}
+
+static void init_quant_model(QuantModel *model, const HYDStaticPreset *preset) {
+    model->preset = preset;
+    for (size_t i = 0; i < 3 * 458; i++)
+        model->clusters[i] = static_hf_cluster(111 + i);
+    for (int c = 0; c < HYD_STATIC_HF_CLUSTERS; c++) {
+        for (uint32_t v = 0; v < 64; v++)
+            model->bits[c][v] = hyd_entropy_static_bits(&preset->hf[c], v);
+    }
+}
+
+static inline float quant_model_bits(const QuantModel *model, size_t cluster, int32_t value) {
+    const uint32_t symbol = hyd_pack_signed(value);
+    return symbol < 64 ? model->bits[cluster][symbol] : hyd_entropy_static_bits(&model->preset->hf[cluster], symbol);
+}
+
+/*
+ * Quantize channel c of a varblock, with scaled holding its coefficients in quant steps, in natural order.
+ * Each one is truncated, rounded or zeroed, whichever costs the least in bits, going by model in the
+ * context it would be coded in, plus squared error in DCT8 steps. Then whatever comes after the last
+ * coefficient that pays for itself, counting the zeros coded in between, is dropped. Contexts go by
+ * position in order, the scan order they're coded in, or natural order if it's NULL.
+ */
+static void quantize_rdo(const QuantModel *model, const VarblockLayout *layout, const uint8_t *order, int c,
+                         const float *scaled, int32_t *quant) {
+    const size_t block_context = c < 2 ? 1 - c : c;
+    const float *step_error = layout->step_error[c];
+    const size_t covered = layout->side * layout->side;
+    const int log_covered = hyd_cllog2(covered);
+    /* estimated non-zeroes left from each scan position on, which the coefficient contexts depend on */
+    uint16_t remaining[1025];
+    float zero_error[1025];
+    remaining[layout->size] = 0;
+    zero_error[layout->size] = 0.f;
+    for (size_t k = layout->size - 1; k >= covered; k--) {
+        const size_t j = order ? order[k] : k;
+        remaining[k] = remaining[k + 1] + (hyd_abs(scaled[j]) >= 2.f);
+        zero_error[k] = zero_error[k + 1] + step_error[j] * scaled[j] * scaled[j];
+    }
+
+    unsigned int prev = remaining[covered] <= layout->size >> 4;
+    float cost = 0.f, best_cost = QUANT_BITS_PER_ERROR * zero_error[covered];
+    size_t end = covered;
+    for (size_t k = covered; k < layout->size; k++) {
+        const size_t j = order ? order[k] : k;
+        const float a = hyd_abs(scaled[j]);
+        const size_t left = hyd_max(remaining[k], 1);
+        const size_t cluster = model->clusters[458 * block_context + prev +
+            ((coeff_num_non_zero_context[(left + covered - 1) >> log_covered]
+            + coeff_freq_context[k >> log_covered]) << 1)];
+        uint32_t best = 0;
+        const float lambda = QUANT_BITS_PER_ERROR * step_error[j];
+        float best_here = model->bits[cluster][0] + lambda * a * a;
+        for (uint32_t q = hyd_max((uint32_t)a, 1); q <= (uint32_t)a + 1; q++) {
+            const int32_t v = scaled[j] < 0.f ? -(int32_t)q : (int32_t)q;
+            const float e = a - dequantized(q);
+            const float here = quant_model_bits(model, cluster, v) + lambda * e * e;
+            if (here < best_here) {
+                best_here = here;
+                best = q;
+            }
+        }
+        quant[j] = scaled[j] < 0.f ? -(int32_t)best : (int32_t)best;
+        cost += best_here;
+        prev = !!best;
+        if (best && cost + QUANT_BITS_PER_ERROR * zero_error[k + 1] < best_cost) {
+            best_cost = cost + QUANT_BITS_PER_ERROR * zero_error[k + 1];
+            end = k + 1;
+        }
+    }
+    for (size_t k = end; k < layout->size; k++)
+        quant[order ? order[k] : k] = 0;
+}
+
+/* whether the coefficient at natural index n of a varblock is coded in this pass */
+static inline int in_pass(const HYDEncoder *encoder, const VarblockLayout *layout, size_t n, unsigned int pass) {
+    const uint8_t *bands = pass_bands[encoder->num_passes - 1];
+    return layout->band[n] < bands[pass] && (!pass || layout->band[n] >= bands[pass - 1]);
+}
+
+/*
+ * Send the symbols of one pass of an LF group, whose groups start at gindex in hf_coeffs. The counts
+ * in non_zeroes cover every pass, so with more than one they're recounted, over the pass's own.
+ */
+static HYDStatusCode initialize_hf_coeffs(HYDEncoder *encoder, HYDEntropyStream *stream, HYDLFGroup *lf_group,
+                                          const VarblockLayout *layouts, uint16_vec3 *non_zeroes, size_t lfid,
+                                          unsigned int pass, size_t gindex) {
+    HYDStatusCode ret;
+    size_t preset = lfid / hyd_ceil_div(encoder->lfg_per_frame, 256); // this is always < 256
+    const int cllog2_num_presets = hyd_cllog2(hyd_min(encoder->lfg_per_frame, 256));
+    HFBarrier *symbol_count = encoder->hf_stream_barrier;
+    for (size_t gy = 0; gy < lf_group->tile_count_y; gy++) {
+        if (gy << 8 >= lf_group->height)
+            break;
+        const size_t gh = (gy + 1) << 8 > lf_group->height ?
+            lf_group->height - (gy << 8) : 256;
+        const size_t gbh = (gh + 7) >> 3;
+        for (size_t gx = 0; gx < lf_group->tile_count_x; gx++) {
+            if (gx << 8 >= lf_group->width)
+                break;
+            const size_t gw = (gx + 1) << 8 > lf_group->width ?
+                lf_group->width - (gx << 8) : 256;
+            const size_t gbw = (gw + 7) >> 3;
+            if (static_preset(encoder)) {
+                HYDBitWriter *bw = &encoder->hf_coeffs[gindex];
+                if (!bw->buffer) {
+                    ret = hyd_init_paged_bit_writer(bw, &encoder->page_pool);
+                    if (ret < HYD_ERROR_START)
+                        return ret;
+                    hyd_write(bw, preset, cllog2_num_presets);
+                }
+                hyd_entropy_set_static_writer(stream, bw);
+            }
+            for (size_t by = 0; by < gbh; by++) {
+                const size_t vy = (by << 3) + (gy << 8);
+                for (size_t bx = 0; bx < gbw; bx++) {
+                    const size_t vx = (bx << 3) + (gx << 8);
+                    const uint8_t acs = encoder->ac_strategy[(vy >> 3) * lf_group->varblock_width + (vx >> 3)];
+                    if (acs == ACS_COVERED)
+                        continue;
+                    const VarblockLayout *layout = varblock_layout(layouts, acs);
+                    const size_t covered = layout->side * layout->side;
+                    const int log_covered = hyd_cllog2(covered);
+                    const XYBEntry *base = &encoder->xyb[vy * lf_group->stride + vx];
+                    for (unsigned int i = 0; i < 3; i++) {
+                        unsigned int c = i < 2 ? 1 - i : i;
+                        uint8_t predicted = get_predicted_non_zeroes(non_zeroes, by, bx, gbw, c);
+                        size_t block_context = i;
+                        size_t non_zero_context = 1485 * preset + 3 * get_non_zero_context(predicted) + block_context;
+                        uint32_t non_zero_count = non_zeroes[by * gbw + bx].v[c];
+                        if (encoder->num_passes > 1) {
+                            non_zero_count = 0;
+                            for (size_t n = covered; n < layout->size; n++) {
+                                if (in_pass(encoder, layout, n, pass))
+                                    non_zero_count += !!base[layout->offsets[n]].xyb[c].i;
+                            }
+                            non_zeroes[by * gbw + bx].v[c] = non_zero_count;
+                        }
+                        ret = hyd_entropy_send_symbol(stream, non_zero_context, non_zero_count);
+                        symbol_count[gindex].barrier_index++;
+                        if (ret < HYD_ERROR_START)
+                            return ret;
+                        /* the blocks of a varblock each predict their neighbors with its average count */
+                        if (covered > 1) {
+                            const uint16_t average = (non_zero_count + covered - 1) >> log_covered;
+                            for (size_t y = by; y < by + layout->side; y++) {
+                                for (size_t x = bx; x < bx + layout->side; x++)
+                                    non_zeroes[y * gbw + x].v[c] = average;
+                            }
+                        }
+                        if (!non_zero_count)
+                            continue;
+                        //size_t hist_context = 458 * block_context + 555;
+                        size_t hist_context = 1485 * preset + 458 * block_context + 111;
+                        /* only DCT8 has a custom order */
+                        const uint8_t *order = acs == ACS_DCT8 ? encoder->coeff_order[c] : NULL;
+                        unsigned int prev = non_zero_count <= layout->size >> 4;
+                        for (size_t k = covered; k < layout->size; k++) {
+                            const size_t n = order ? order[k] : k;
+                            size_t coeff_context = hist_context + prev +
+                                ((coeff_num_non_zero_context[(non_zero_count + covered - 1) >> log_covered]
+                                + coeff_freq_context[k >> log_covered]) << 1);
+                            uint32_t value = in_pass(encoder, layout, n, pass) ?
+                                hyd_pack_signed(base[layout->offsets[n]].xyb[c].i) : 0;
+                            ret = hyd_entropy_send_symbol(stream, coeff_context, value);
+                            symbol_count[gindex].barrier_index++;
+                            if (ret < HYD_ERROR_START)
+                                return ret;
+                            prev = !!value;
+                            if (value && !--non_zero_count)
+                                break;
+                        }
+                    }
+                }
+            }
+            non_zeroes += 1 << 10;
+            symbol_count[gindex++].preset = preset;
+        }
+    }
+
+    return encoder->working_writer.overflow_state;
+}
+
+/* the per-block fields are allocated once, big enough for the largest LF group */
+static HYDStatusCode alloc_block_fields(HYDEncoder *encoder) {
+    if (!encoder->hf_mult_field)
+        encoder->hf_mult_field = malloc(1 << 16);
+    if (!encoder->ac_strategy)
+        encoder->ac_strategy = malloc(1 << 16);
+    return encoder->hf_mult_field && encoder->ac_strategy ? HYD_OK : HYD_NOMEM;
+}
+
+/* adaptive quantization is from effort 3 up, and below that every block gets the base multiplier */
+static HYDStatusCode init_hf_mult_field(HYDEncoder *encoder, const HYDLFGroup *lf_group) {
+    if (encoder->effort >= 3)
+        return compute_hf_mult_field(encoder, lf_group);
+    memset(encoder->hf_mult_field, encoder->hf_mult, lf_group->varblock_width * lf_group->varblock_height);
+    return HYD_OK;
+}
+
+/* the AQ field, AC strategy and CfL factors, as far as the effort asks for them */
+static HYDStatusCode analyze_lf_group(HYDEncoder *encoder, const HYDLFGroup *lf_group,
+                                      const VarblockLayout *layouts) {
+    HYDStatusCode ret = init_hf_mult_field(encoder, lf_group);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    memset(encoder->ac_strategy, ACS_DCT8, lf_group->varblock_width * lf_group->varblock_height);
+    if (encoder->effort >= 4) {
+        ret = compute_ac_strategy(encoder, lf_group, layouts);
+        if (ret < HYD_ERROR_START)
+            return ret;
+    }
+    if (encoder->effort >= 2)
+        compute_cfl_factors(encoder, lf_group);
+    else
+        memset(encoder->cfl_factors, 0, sizeof(encoder->cfl_factors));
 
+    return HYD_OK;
+}
+
+static void tally_hf_symbol(HFTally *tally, const HYDStaticPreset *preset, uint8_t cluster, uint32_t symbol) {
+    static const HYDHybridUintConfig hf_config = { 4, 1, 0 };
+    if (preset) {
+        tally->bits += hyd_entropy_static_bits(&preset->hf[cluster], symbol);
+        return;
+    }
+    uint32_t residue_bits;
+    tally->tokens[cluster][hyd_entropy_token(&hf_config, symbol, &residue_bits)]++;
+    tally->bits += residue_bits;
+}
+
+/*
+ * Tally the symbols channel c of a varblock codes, the way initialize_hf_coeffs sends them, except
+ * that the coefficients go in natural order, as the coefficient order isn't picked yet.
+ */
+static void tally_varblock(HFTally *tally, const HYDStaticPreset *preset, const QuantModel *model,
+                           const VarblockLayout *layout, uint16_vec3 *non_zeroes, size_t by, size_t bx,
+                           size_t gbw, int c, const int32_t *quant) {
+    const size_t block_context = c < 2 ? 1 - c : c;
+    const size_t covered = layout->side * layout->side;
+    const int log_covered = hyd_cllog2(covered);
+    const uint8_t predicted = get_predicted_non_zeroes(non_zeroes, by, bx, gbw, c);
+    uint32_t non_zero_count = non_zeroes[by * gbw + bx].v[c];
+    tally_hf_symbol(tally, preset, static_hf_cluster(3 * get_non_zero_context(predicted) + block_context),
+        non_zero_count);
+    if (covered > 1) {
+        const uint16_t average = (non_zero_count + covered - 1) >> log_covered;
+        for (size_t y = by; y < by + layout->side; y++) {
+            for (size_t x = bx; x < bx + layout->side; x++)
+                non_zeroes[y * gbw + x].v[c] = average;
+        }
+    }
+    unsigned int prev = non_zero_count <= layout->size >> 4;
+    for (size_t k = covered; k < layout->size && non_zero_count; k++) {
+        const size_t cluster = model->clusters[458 * block_context + prev +
+            ((coeff_num_non_zero_context[(non_zero_count + covered - 1) >> log_covered]
+            + coeff_freq_context[k >> log_covered]) << 1)];
+        tally_hf_symbol(tally, preset, cluster, hyd_pack_signed(quant[k]));
+        prev = !!quant[k];
+        non_zero_count -= prev;
+    }
+}
+
+/*
+ * Quantize the HF coefficients of lf_group into the XYB buffer, with their count per block and channel
+ * in non_zeroes, and which DCT8 positions they take in coeff_hits. If tally is set, the symbols they'd be
+ * coded with are tallied there instead, and the XYB buffer and coeff_hits are left alone.
+ * Returns the number of symbols the coefficients take at most, to size the HF stream with.
+ */
+static size_t quantize_hf(HYDEncoder *encoder, const HYDLFGroup *lf_group, const VarblockLayout *layouts,
+                          const QuantModel *model, uint16_vec3 *non_zeroes, uint32_t coeff_hits[3][64],
+                          HFTally *tally) {
+    const HYDStaticPreset *preset = static_preset(encoder);
+    const size_t lf_pad_w = lf_group->varblock_width << 3;
+    const size_t cfl_width = (lf_group->varblock_width + 7) >> 3;
     size_t non_zero_count = 0;
     size_t gindex = 0;
-    const size_t lf_pad_w = lf_group->varblock_width << 3;
+    float scaled[1024];
+    int32_t quant[3][1024];
     for (size_t gy = 0; gy < lf_group->tile_count_y; gy++) {
         if (gy << 5 >= lf_group->varblock_height)
             break;
@@ -795,26 +1951,58 @@ HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t t
             const size_t gw = (gx + 1) << 8 > lf_group->width ?
                 lf_group->width - (gx << 8) : 256;
             const size_t gbw = (gw + 7) >> 3;
+            uint16_vec3 *group_non_zeroes = &non_zeroes[gindex << 10];
             for (size_t by = 0; by < gbh; by++) {
                 const size_t vy = (by << 3) + (gy << 8);
                 for (size_t bx = 0; bx < gbw; bx++) {
                     const size_t vx = (bx << 3) + (gx << 8);
-                    for (int i = 0; i < 3; i++) {
+                    const size_t block = (vy >> 3) * lf_group->varblock_width + (vx >> 3);
+                    const uint8_t acs = encoder->ac_strategy[block];
+                    if (acs == ACS_COVERED)
+                        continue;
+                    const VarblockLayout *layout = varblock_layout(layouts, acs);
+                    const float *weights = layout->weights;
+                    const size_t size = layout->size;
+                    /* the weights are for globalScale = 32768 */
+                    const float hf_scale = (float)encoder->hf_mult_field[block] * encoder->global_scale / 32768.f;
+                    const size_t cfl_pos = (vy >> 6) * cfl_width + (vx >> 6);
+                    const float cfl[3] = {
+                        encoder->cfl_factors[0][cfl_pos] / 84.f, 0.f, encoder->cfl_factors[1][cfl_pos] / 84.f,
+                    };
+                    XYBEntry *base = &encoder->xyb[vy * lf_pad_w + vx];
+                    /* Y goes first, as X and B are predicted from what the decoder gets back for it */
+                    for (int c = 0; c < 3; c++) {
+                        const int i = (c + 1) % 3;
                         size_t nzc = 0;
-                        for (int j = 1; j < 64; j++) {
-                            const size_t py = vy + natural_order[j].y;
-                            const size_t px = vx + natural_order[j].x;
-                            XYBEntry *xyb = &encoder->xyb[py * lf_pad_w + px];
-                            const int32_t q = (int32_t)(xyb->xyb[i].f * hf_quant_weights[i][j] * hf_mult);
-                            if (hyd_abs(q) < 2) {
-                                xyb->xyb[i].i = 0;
-                            } else {
-                                xyb->xyb[i].i = q;
-                                non_zeroes[(gindex << 10) + by * gbw + bx].v[i]++;
-                                nzc = j;
-                            }
+                        uint16_t count = 0;
+                        for (size_t j = layout->side * layout->side; j < size; j++) {
+                            float coeff = base[layout->offsets[j]].xyb[i].f;
+                            if (i != 1)
+                                coeff -= cfl[i] * quant[1][j] / (weights[size + j] * hf_scale);
+                            scaled[j] = coeff * weights[i * size + j] * hf_scale;
+                            quant[i][j] = hyd_abs(scaled[j]) < 2.f ? 0 : (int32_t)scaled[j];
+                        }
+                        if (encoder->rdo_quant) {
+                            /* the first LF group picks the order, so it's quantized for natural order */
+                            const uint8_t *order = acs == ACS_DCT8 && encoder->custom_coeff_order ?
+                                encoder->coeff_order[i] : NULL;
+                            quantize_rdo(model, layout, order, i, scaled, quant[i]);
                         }
+                        for (size_t j = layout->side * layout->side; j < size; j++) {
+                            const int32_t q = quant[i][j];
+                            if (!tally)
+                                base[layout->offsets[j]].xyb[i].i = q;
+                            if (!q)
+                                continue;
+                            count++;
+                            nzc = j;
+                            if (!tally && acs == ACS_DCT8)
+                                coeff_hits[i][j]++;
+                        }
+                        group_non_zeroes[by * gbw + bx].v[i] = count;
                         non_zero_count += nzc;
+                        if (tally)
+                            tally_varblock(tally, preset, model, layout, group_non_zeroes, by, bx, gbw, i, quant[i]);
                     }
                 }
             }
@@ -822,9 +2010,349 @@ HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t t
         }
     }
 
+    return non_zero_count;
+}
+
+/*
+ * Bits for LF samples laid out the way write_lf_samples takes them, quantized by scale, going by the
+ * same predictor and a histogram of their tokens, without the LZ77 they get.
+ */
+static HYDStatusCode estimate_lf_sample_bits(const HYDEncoder *encoder, const XYBEntry *base, size_t width,
+                                             size_t height, size_t x_step, size_t y_step, const float scale[3],
+                                             float *bits) {
+    static const HYDHybridUintConfig lf_config = { 7, 1, 1 };
+    const HYDStaticPreset *preset = static_preset(encoder);
+    HYDStatusCode ret = HYD_OK;
+    uint32_t *histogram = calloc(LF_TALLY_TOKENS, sizeof(*histogram));
+    int32_t *rows = hyd_malloc_array(2 * width, sizeof(*rows));
+    if (!histogram || !rows) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+
+    *bits = 0.f;
+    for (int c = 0; c < 3; c++) {
+        for (size_t y = 0; y < height; y++) {
+            int32_t *row = &rows[(y & 1) * width];
+            const int32_t *up = &rows[(~y & 1) * width];
+            const XYBEntry *xyb = &base[y * y_step];
+            for (size_t x = 0; x < width; x++) {
+                row[x] = xyb[x * x_step].xyb[c].f * scale[c];
+                const int32_t w = x > 0 ? row[x - 1] : y > 0 ? up[x] : 0;
+                const int32_t n = y > 0 ? up[x] : w;
+                const int32_t nw = x > 0 && y > 0 ? up[x - 1] : w;
+                const int32_t min = hyd_min(w, n);
+                const int32_t v = hyd_clamp(w + n - nw, min, w ^ n ^ min);
+                const uint32_t symbol = hyd_pack_signed(row[x] - v);
+                if (preset) {
+                    *bits += hyd_entropy_static_bits(&preset->lf, symbol);
+                } else {
+                    uint32_t residue_bits;
+                    histogram[hyd_entropy_token(&lf_config, symbol, &residue_bits)]++;
+                    *bits += residue_bits;
+                }
+            }
+        }
+    }
+    *bits += hyd_entropy_histogram_bits(histogram, LF_TALLY_TOKENS);
+
+end:
+    hyd_freep(&histogram);
+    hyd_freep(&rows);
+    return ret;
+}
+
+/* bits for the LF coefficients of lf_group and its AQ field, going by their histograms */
+static HYDStatusCode estimate_lf_bits(const HYDEncoder *encoder, const HYDLFGroup *lf_group, float *bits) {
+    const size_t bw = lf_group->varblock_width;
+    const size_t bh = lf_group->varblock_height;
+    float scale[3];
+    lf_quant_scales(encoder, scale, 0);
+    HYDStatusCode ret = estimate_lf_sample_bits(encoder, encoder->xyb, bw, bh, 8, lf_group->stride << 3,
+        scale, bits);
+    if (ret < HYD_ERROR_START)
+        return ret;
+
+    /* the rest of the block info is mostly runs, but the AQ field is not */
+    uint32_t histogram[LF_TALLY_TOKENS] = { 0 };
+    for (size_t i = 0; i < bw * bh; i++)
+        histogram[encoder->hf_mult_field[i]]++;
+    *bits += hyd_entropy_histogram_bits(histogram, LF_TALLY_TOKENS);
+
+    return HYD_OK;
+}
+
+/*
+ * Bits for the part of the preview that lf_group covers. LF coefficients are block averages, so
+ * averaging them down to the preview's scale gives its pixels there. A preview finer than the LF
+ * is taken to cost as much per pixel as the LF does per block, which overestimates it a little.
+ */
+static HYDStatusCode estimate_preview_bits(const HYDEncoder *encoder, const HYDLFGroup *lf_group, float *bits) {
+    const size_t bw = lf_group->varblock_width;
+    const size_t bh = lf_group->varblock_height;
+    const int shift = hyd_max(encoder->preview_shift - 3, 0);
+    const size_t pw = hyd_ceil_div(bw, (size_t)1 << shift);
+    const size_t ph = hyd_ceil_div(bh, (size_t)1 << shift);
+    HYDStatusCode ret;
+    float scale[3];
+    lf_quant_scales(encoder, scale, 1);
+    XYBEntry *samples = hyd_malloc_array(pw * ph, sizeof(*samples));
+    if (!samples)
+        return HYD_NOMEM;
+    for (size_t py = 0; py < ph; py++) {
+        const size_t rows = hyd_min(bh - (py << shift), (size_t)1 << shift);
+        for (size_t px = 0; px < pw; px++) {
+            const size_t cols = hyd_min(bw - (px << shift), (size_t)1 << shift);
+            XYBEntry *sample = &samples[py * pw + px];
+            for (int c = 0; c < 3; c++) {
+                float sum = 0.f;
+                for (size_t y = 0; y < rows; y++) {
+                    const XYBEntry *xyb = &encoder->xyb[lf_group->stride * (((py << shift) + y) << 3)];
+                    for (size_t x = 0; x < cols; x++)
+                        sum += xyb[((px << shift) + x) << 3].xyb[c].f;
+                }
+                sample->xyb[c].f = sum / (rows * cols);
+            }
+        }
+    }
+    ret = estimate_lf_sample_bits(encoder, samples, pw, ph, 1, pw, scale, bits);
+    if (encoder->preview_shift < 3)
+        *bits *= 1 << (2 * (3 - encoder->preview_shift));
+    hyd_freep(&samples);
+
+    return ret;
+}
+
+/* estimated bytes for lf_group's frame data at the current settings, without touching its XYB buffer */
+static HYDStatusCode estimate_lf_group_size(HYDEncoder *encoder, const HYDLFGroup *lf_group,
+                                            const VarblockLayout *layouts, const QuantModel *model,
+                                            uint16_vec3 *non_zeroes, HFTally *tally, size_t *size) {
+    float bits;
+    HYDStatusCode ret = estimate_lf_bits(encoder, lf_group, &bits);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    memset(tally, 0, sizeof(*tally));
+    quantize_hf(encoder, lf_group, layouts, model, non_zeroes, NULL, tally);
+    bits += tally->bits;
+    if (!static_preset(encoder)) {
+        for (int c = 0; c < HYD_STATIC_HF_CLUSTERS; c++)
+            bits += ESTIMATE_HF_CLUSTER_GAIN * hyd_entropy_histogram_bits(tally->tokens[c], HF_TALLY_TOKENS);
+    }
+    const size_t num_groups = ((lf_group->width + 255) >> 8) * ((lf_group->height + 255) >> 8);
+    *size = (size_t)(bits / 8.f) + ESTIMATE_GROUP_BYTES * num_groups;
+    if (!encoder->one_frame || (!lf_group->x && !lf_group->y))
+        *size += ESTIMATE_FRAME_BYTES;
+
+    return HYD_OK;
+}
+
+/* the distances a target size picks from, 0.1 * 2^(k/8) for k up to 64, which are about 9% apart */
+static float target_distance(unsigned int k) {
+    static const float eighths[8] = {
+        1.f, 1.0905077f, 1.1892071f, 1.2968396f, 1.4142136f, 1.5422108f, 1.6817928f, 1.8340081f,
+    };
+    return hyd_min(25.f, 0.1f * (1 << (k >> 3)) * eighths[k & 7]);
+}
+
+/*
+ * Set the quantizer to the lowest distance at which lf_group's estimated size fits its share of the
+ * target size, by area. The estimates leave out the AC strategy and CfL, which only make the real
+ * thing smaller, so it ends up a little under the target at higher effort. The preview counts its
+ * part of lf_group too, as its quantization goes with the distance. The LF frame holds the same LF
+ * the estimate already counts, so that one only adds the frame's own headers.
+ */
+static HYDStatusCode fit_target_size(HYDEncoder *encoder, const HYDLFGroup *lf_group,
+                                     const VarblockLayout *layouts, const QuantModel *model,
+                                     uint16_vec3 *non_zeroes, HFTally *tally) {
+    HYDStatusCode ret;
+    size_t header = ESTIMATE_HEADER_BYTES + encoder->icc_size;
+    if (encoder->metadata.preview)
+        header += ESTIMATE_FRAME_BYTES;
+    if (encoder->metadata.lf_frame)
+        header += ESTIMATE_FRAME_BYTES;
+    const float share = (float)lf_group->input_width * lf_group->input_height /
+        ((float)encoder->metadata.width * encoder->metadata.height);
+    const float budget = encoder->target_size > header ? (encoder->target_size - header) * share : 0.f;
+    memset(encoder->ac_strategy, ACS_DCT8, lf_group->varblock_width * lf_group->varblock_height);
+    memset(encoder->cfl_factors, 0, sizeof(encoder->cfl_factors));
+    unsigned int lo = 0, hi = 64;
+    while (lo < hi) {
+        const unsigned int mid = (lo + hi) >> 1;
+        size_t size;
+        hyd_set_distance(encoder, target_distance(mid));
+        ret = init_hf_mult_field(encoder, lf_group);
+        if (ret < HYD_ERROR_START)
+            return ret;
+        ret = estimate_lf_group_size(encoder, lf_group, layouts, model, non_zeroes, tally, &size);
+        if (ret < HYD_ERROR_START)
+            return ret;
+        if (encoder->metadata.preview) {
+            float preview_bits;
+            ret = estimate_preview_bits(encoder, lf_group, &preview_bits);
+            if (ret < HYD_ERROR_START)
+                return ret;
+            size += (size_t)(preview_bits / 8.f);
+        }
+        if (size <= budget)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    hyd_set_distance(encoder, target_distance(lo));
+
+    return HYD_OK;
+}
+
+HYDStatusCode hyd_estimate_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t tile_y, size_t *size) {
+    uint16_vec3 *non_zeroes = NULL;
+    VarblockLayout *layouts = NULL;
+    QuantModel *quant_model = NULL;
+    HFTally *tally = NULL;
+    HYDStatusCode ret;
+
+    const size_t lfid = encoder->one_frame ? tile_y * encoder->lfg_count_x + tile_x : 0;
+    HYDLFGroup *lf_group = &encoder->lfg[lfid];
+    forward_dct(encoder, lf_group);
+
+    const size_t num_groups = ((lf_group->width + 255) >> 8) * ((lf_group->height + 255) >> 8);
+    non_zeroes = calloc(num_groups << 10, sizeof(*non_zeroes));
+    layouts = hyd_malloc_array(3, sizeof(*layouts));
+    quant_model = malloc(sizeof(*quant_model));
+    tally = malloc(sizeof(*tally));
+    if (!non_zeroes || !layouts || !quant_model || !tally) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+    for (int i = 0; i < 3; i++)
+        init_varblock_layout(&layouts[i], i, lf_group->stride);
+    init_quant_model(quant_model, static_preset(encoder) ? static_preset(encoder) : &hyd_static_presets[0]);
+    ret = alloc_block_fields(encoder);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    ret = analyze_lf_group(encoder, lf_group, layouts);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    ret = estimate_lf_group_size(encoder, lf_group, layouts, quant_model, non_zeroes, tally, size);
+
+end:
+    hyd_freep(&non_zeroes);
+    hyd_freep(&layouts);
+    hyd_freep(&quant_model);
+    hyd_freep(&tally);
+    return ret;
+}
+
+/* keep the tile's frame past its header, which is all in the working writer, in its tile cache slot */
+static void cache_tile(HYDEncoder *encoder) {
+    HYDCachedTile *slot = &encoder->tile_cache[encoder->tile_key % encoder->tile_cache_slots];
+    /* without the samples to check a hit against, the frame can't be reused */
+    if (!slot->samples)
+        return;
+    const size_t size = hyd_bitwriter_tell(&encoder->working_writer);
+    /* the tile is still written out if there's no room to keep it */
+    if (hyd_realloc_p(&slot->data, size) < HYD_ERROR_START) {
+        hyd_freep(&slot->data);
+        slot->size = 0;
+        return;
+    }
+    hyd_bitwriter_copy(&encoder->working_writer, slot->data);
+    slot->key = encoder->tile_key;
+    slot->size = size;
+}
+
+HYDStatusCode hyd_encode_cached_tile(HYDEncoder *encoder) {
+    const HYDCachedTile *slot = &encoder->tile_cache[encoder->tile_key % encoder->tile_cache_slots];
+    hyd_bitwriter_release(&encoder->working_writer);
+    HYDStatusCode ret = hyd_init_paged_bit_writer(&encoder->working_writer, &encoder->page_pool);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    encoder->copy_pos = 0;
+    ret = hyd_write_bytes(&encoder->working_writer, slot->data, slot->size);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    encoder->wrote_frame_header = 0;
+    return hyd_flush(encoder);
+}
+
+HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t tile_y) {
+    uint16_vec3 *non_zeroes = NULL;
+    uint8_t *hf_cluster_map = NULL;
+    VarblockLayout *layouts = NULL;
+    QuantModel *quant_model = NULL;
+    HFTally *tally = NULL;
+    HYDBitWriter head_bw = { 0 };
+    HYDStatusCode ret = HYD_OK;
+    int need_buffer_init = !encoder->working_writer.pool || !encoder->one_frame;
+    if (need_buffer_init) {
+        hyd_bitwriter_release(&encoder->working_writer);
+        ret = hyd_init_paged_bit_writer(&encoder->working_writer, &encoder->page_pool);
+        encoder->copy_pos = 0;
+    }
+
+    if (ret < HYD_ERROR_START)
+        goto end;
+
+    const size_t lfid = encoder->one_frame ? tile_y * encoder->lfg_count_x + tile_x : 0;
+    HYDLFGroup *lf_group = &encoder->lfg[lfid];
+    size_t num_frame_groups;
+    size_t frame_h = encoder->one_frame ? coded_height(encoder) : encoder->lfg->height;
+    size_t frame_w = encoder->one_frame ? coded_width(encoder) : encoder->lfg->width;
+    size_t frame_groups_y = (frame_h + 255) >> 8;
+    size_t frame_groups_x = (frame_w + 255) >> 8;
+    num_frame_groups = frame_groups_x * frame_groups_y;
+    encoder->num_hf_coeff_bw = encoder->num_passes * num_frame_groups;
+    /* otherwise the TOC has one entry, and the frame is one section */
+    const int multi_section = num_frame_groups > 1 || encoder->num_passes > 1;
+
+    const size_t num_groups = ((lf_group->width + 255) >> 8) * ((lf_group->height + 255) >> 8);
+    non_zeroes = calloc(num_groups << 10, sizeof(*non_zeroes));
+    layouts = hyd_malloc_array(3, sizeof(*layouts));
+    quant_model = malloc(sizeof(*quant_model));
+    if (!non_zeroes || !layouts || !quant_model) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+    for (int i = 0; i < 3; i++)
+        init_varblock_layout(&layouts[i], i, lf_group->stride);
+
+    uint32_t coeff_hits[3][64] = { 0 };
+    /* RDO quantization estimates bits with the static codes, the photo ones unless others are in use */
+    init_quant_model(quant_model, static_preset(encoder) ? static_preset(encoder) : &hyd_static_presets[0]);
+    ret = alloc_block_fields(encoder);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    if (encoder->metadata.lf_frame && !encoder->lf_frame_samples) {
+        encoder->lf_frame_samples = hyd_malloc_array(hyd_ceil_div(encoder->metadata.width, 8)
+            * hyd_ceil_div(encoder->metadata.height, 8), sizeof(*encoder->lf_frame_samples));
+        if (!encoder->lf_frame_samples) {
+            ret = HYD_NOMEM;
+            goto end;
+        }
+    }
+    /* each frame starts out in natural order, not the last frame's, until its first LF group picks one */
+    if (!encoder->tiles_sent)
+        encoder->custom_coeff_order = 0;
+    /* later LF groups of the frame are stuck with the quantizer in its LF global section */
+    if (encoder->target_size && !encoder->tiles_sent) {
+        tally = malloc(sizeof(*tally));
+        if (!tally) {
+            ret = HYD_NOMEM;
+            goto end;
+        }
+        ret = fit_target_size(encoder, lf_group, layouts, quant_model, non_zeroes, tally);
+        if (ret < HYD_ERROR_START)
+            goto end;
+    }
+    ret = analyze_lf_group(encoder, lf_group, layouts);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    quantize_hf(encoder, lf_group, layouts, quant_model, non_zeroes, coeff_hits, NULL);
+
     if (!encoder->tiles_sent) {
-        if (num_frame_groups > 1) {
-            const size_t count = 2 + encoder->lfg_per_frame + num_frame_groups;
+        /* the rest of the frame's LF groups are scanned in the order picked from this one */
+        compute_coeff_order(encoder, lf_group, coeff_hits);
+        if (multi_section) {
+            const size_t count = 2 + encoder->lfg_per_frame + encoder->num_hf_coeff_bw;
             ret = hyd_calloc_arraybuffer_p(count, sizeof(*encoder->section_endpos), encoder->section_endpos_array,
                 sizeof(encoder->section_endpos_array), &encoder->section_endpos);
             if (ret < HYD_ERROR_START)
@@ -834,9 +2362,9 @@ HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t t
         ret = write_lf_global(encoder);
         if (ret < HYD_ERROR_START)
             goto end;
-        if (num_frame_groups > 1) {
+        if (multi_section) {
             hyd_bitwriter_flush(&encoder->working_writer);
-            encoder->section_endpos[encoder->section_count++] = encoder->working_writer.buffer_pos;
+            encoder->section_endpos[encoder->section_count++] = hyd_bitwriter_tell(&encoder->working_writer);
         }
     }
 
@@ -844,14 +2372,13 @@ HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t t
     if (ret < HYD_ERROR_START)
         goto end;
 
-    if (num_frame_groups > 1) {
+    if (multi_section) {
         hyd_bitwriter_flush(&encoder->working_writer);
-        encoder->section_endpos[encoder->section_count++] = encoder->working_writer.buffer_pos;
+        encoder->section_endpos[encoder->section_count++] = hyd_bitwriter_tell(&encoder->working_writer);
     }
 
     const unsigned int num_presets = hyd_min(encoder->lfg_per_frame, 256);
     const size_t cluster_map_size = 1485ul * num_presets;
-    HYDEntropyStream *hf_stream = &encoder->hf_stream;
     if (!encoder->tiles_sent) {
         const size_t num_syms = 1 << 12;
         hf_cluster_map = malloc(cluster_map_size);
@@ -859,71 +2386,54 @@ HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t t
             ret = HYD_NOMEM;
             goto end;
         }
-        if (num_presets * 9 <= 256) {
-            for (unsigned int i = 0; i < num_presets; i++) {
-                uint8_t *preset_map = hf_cluster_map + 1485ul * i;
-                for (unsigned int j = 0; j < 111; j += 3) {
-                    preset_map[j] = 9 * i;
-                    preset_map[j + 1] = 9 * i + 1;
-                    preset_map[j + 2] = 9 * i + 2;
-                }
-                for (unsigned int j = 111; j < 1485; j += 6) {
-                    preset_map[j] = 9 * i + 3;
-                    preset_map[j + 1] = 9 * i + 4;
-                    preset_map[j + 2] = 9 * i + 5;
-                    preset_map[j + 3] = 9 * i + 6;
-                    preset_map[j + 4] = 9 * i + 7;
-                    preset_map[j + 5] = 9 * i + 8;
-                }
-            }
-        } else if (num_presets * 3 <= 256) {
-            for (unsigned int i = 0; i < num_presets; i++) {
-                uint8_t *preset_map = hf_cluster_map + 1485ul * i;
-                memset(preset_map, 3 * i, 111);
-                for (unsigned int j = 111; j < 1485; j += 6) {
-                    preset_map[j] = 3 * i + 1;
-                    preset_map[j + 2] = 3 * i + 1;
-                    preset_map[j + 4] = 3 * i + 1;
-                    preset_map[j + 1] = 3 * i + 2;
-                    preset_map[j + 3] = 3 * i + 2;
-                    preset_map[j + 5] = 3 * i + 2;
-                }
+        const HYDStaticPreset *preset = static_preset(encoder);
+        for (unsigned int pass = 0; pass < encoder->num_passes; pass++) {
+            HYDEntropyStream *hf_stream = &encoder->hf_stream[pass];
+            if (preset) {
+                for (size_t i = 0; i < cluster_map_size; i++)
+                    hf_cluster_map[i] = static_hf_cluster(i % 1485);
+                ret = hyd_entropy_init_static_stream(hf_stream, hf_cluster_map, cluster_map_size, preset->hf,
+                    &encoder->error);
+                if (ret < HYD_ERROR_START)
+                    goto end;
+            } else {
+                /* every preset starts out in one cluster, and gets split up once its symbols are in */
+                memset(hf_cluster_map, 0, cluster_map_size);
+                ret = hyd_entropy_init_stream(hf_stream, num_syms, hf_cluster_map, cluster_map_size,
+                    1, 0, 0, &encoder->error);
+                if (ret < HYD_ERROR_START)
+                    goto end;
+                ret = hyd_entropy_set_hybrid_config(hf_stream, 0, 0, 4, 1, 0);
+                if (ret < HYD_ERROR_START)
+                    goto end;
+                ret = hyd_entropy_defer_clustering(hf_stream);
+                if (ret < HYD_ERROR_START)
+                    goto end;
+                hyd_entropy_set_coding(hf_stream, entropy_coding(encoder));
             }
-        } else if (num_presets * 2 <= 256) {
-            for (unsigned int i = 0; i < num_presets; i++) {
-                uint8_t *preset_map = hf_cluster_map + 1485ul * i;
-                memset(preset_map, 2 * i, 111);
-                memset(preset_map + 111, 2 * i + 1, 1374);
-            }
-        } else {
-            for (unsigned int i = 0; i < num_presets; i++)
-                memset(hf_cluster_map + 1485ul * i, i, 1485);
         }
-
-        ret = hyd_entropy_init_stream(hf_stream, num_syms, hf_cluster_map, cluster_map_size,
-            1, 0, 0, &encoder->error);
-        if (ret < HYD_ERROR_START)
-            goto end;
         hyd_freep(&hf_cluster_map);
-        ret = hyd_entropy_set_hybrid_config(hf_stream, 0, 0, 4, 1, 0);
-        if (ret < HYD_ERROR_START)
-            goto end;
     }
 
     if (!encoder->hf_coeffs)
-        ret = hyd_realloc_array_p(&encoder->hf_coeffs, num_frame_groups, sizeof(*encoder->hf_coeffs));
-    if (ret < HYD_ERROR_START)
+        encoder->hf_coeffs = calloc(encoder->num_hf_coeff_bw, sizeof(*encoder->hf_coeffs));
+    if (!encoder->hf_coeffs) {
+        ret = HYD_NOMEM;
         goto end;
+    }
     if (!encoder->hf_stream_barrier)
-        encoder->hf_stream_barrier = calloc(num_frame_groups, sizeof(*encoder->hf_stream_barrier));
+        encoder->hf_stream_barrier = calloc(encoder->num_hf_coeff_bw, sizeof(*encoder->hf_stream_barrier));
     if (!encoder->hf_stream_barrier) {
         ret = HYD_NOMEM;
         goto end;
     }
 
-    ret = initialize_hf_coeffs(encoder, hf_stream, lf_group, non_zero_count, non_zeroes, lfid);
-    if (ret < HYD_ERROR_START)
-        goto end;
+    for (unsigned int pass = 0; pass < encoder->num_passes; pass++) {
+        ret = initialize_hf_coeffs(encoder, &encoder->hf_stream[pass], lf_group, layouts, non_zeroes, lfid,
+            pass, pass * num_frame_groups + encoder->groups_encoded);
+        if (ret < HYD_ERROR_START)
+            goto end;
+    }
 
     size_t lfg_per_preset = hyd_ceil_div(encoder->lfg_per_frame, 256);
     size_t preset = lfid / lfg_per_preset;
@@ -931,25 +2441,37 @@ HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t t
     if (encoder->one_frame && preset == (lfid + 1) / lfg_per_preset)
         goto end;
 
-    size_t cluster_from = hf_stream->cluster_map[1485ul * preset];
-    size_t cluster_to = hf_stream->cluster_map[1485ul * (preset + 1) - 1] + 1;
+    /* static codes have written their symbols already */
+    for (unsigned int pass = 0; pass < encoder->num_passes && !static_preset(encoder); pass++) {
+        HYDEntropyStream *hf_stream = &encoder->hf_stream[pass];
+        size_t cluster_from = hf_stream->cluster_map[1485ul * preset];
+        size_t max_clusters = hyd_min(max_hf_clusters(encoder), (256 - cluster_from) / (num_presets - preset));
+        size_t clusters_used;
+        ret = hyd_entropy_cluster(hf_stream, 1485ul * preset, 1485, max_clusters, &clusters_used);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        size_t cluster_to = cluster_from + clusters_used;
 
-    ret = hyd_ans_prepare_frequencies(hf_stream, cluster_from, cluster_to, 0, hf_stream->symbol_count);
-    if (ret < HYD_ERROR_START)
-        goto end;
-    const int cllog2_num_presets = hyd_cllog2(num_presets);
-    size_t soff = 0;
-    for (size_t g = encoder->groups_encoded; g < encoder->groups_encoded + num_groups * lfg_per_preset; g++) {
-        HYDBitWriter *bw = &encoder->hf_coeffs[g];
-        hyd_init_bit_writer(bw, NULL, 0, 0, 0);
-        hyd_write(bw, encoder->hf_stream_barrier[g].preset, cllog2_num_presets);
-        ret = hyd_ans_write_stream_symbols(hf_stream, bw, soff, encoder->hf_stream_barrier[g].barrier_index);
+        ret = hyd_entropy_prepare_stream(hf_stream, cluster_from, cluster_to, 0, hf_stream->symbol_count);
         if (ret < HYD_ERROR_START)
             goto end;
-        soff += encoder->hf_stream_barrier[g].barrier_index;
-    }
+        const int cllog2_num_presets = hyd_cllog2(num_presets);
+        const size_t g0 = pass * num_frame_groups + encoder->groups_encoded;
+        size_t soff = 0;
+        for (size_t g = g0; g < g0 + num_groups * lfg_per_preset; g++) {
+            HYDBitWriter *bw = &encoder->hf_coeffs[g];
+            ret = hyd_init_paged_bit_writer(bw, &encoder->page_pool);
+            if (ret < HYD_ERROR_START)
+                goto end;
+            hyd_write(bw, encoder->hf_stream_barrier[g].preset, cllog2_num_presets);
+            ret = hyd_entropy_write_stream_symbols(hf_stream, bw, soff, encoder->hf_stream_barrier[g].barrier_index);
+            if (ret < HYD_ERROR_START)
+                goto end;
+            soff += encoder->hf_stream_barrier[g].barrier_index;
+        }
 
-    encoder->hf_stream.symbol_count = 0;
+        hf_stream->symbol_count = 0;
+    }
 
     if (encoder->one_frame)
         encoder->groups_encoded += num_groups * lfg_per_preset;
@@ -960,58 +2482,107 @@ HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t t
     hyd_write_bool(&encoder->working_writer, 1);
     // num hf presets
     hyd_write(&encoder->working_writer, num_presets - 1, hyd_cllog2(num_frame_groups));
-    // HF Pass order
-    hyd_write(&encoder->working_writer, 2, 2);
-    ret = hyd_ans_write_stream_header(hf_stream, &encoder->working_writer);
-    if (ret < HYD_ERROR_START)
-        goto end;
-    if (num_frame_groups > 1) {
+    /* each pass has its own orders and histograms */
+    for (unsigned int pass = 0; pass < encoder->num_passes; pass++) {
+        ret = write_coeff_orders(encoder, &encoder->working_writer);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        ret = hyd_entropy_write_stream_header(&encoder->hf_stream[pass], &encoder->working_writer);
+        if (ret < HYD_ERROR_START)
+            goto end;
+    }
+    if (multi_section) {
         hyd_bitwriter_flush(&encoder->working_writer);
-        encoder->section_endpos[encoder->section_count++] = encoder->working_writer.buffer_pos;
+        encoder->section_endpos[encoder->section_count++] = hyd_bitwriter_tell(&encoder->working_writer);
     }
 
-    for (size_t g = 0; g < num_frame_groups; g++) {
+    for (size_t g = 0; g < encoder->num_hf_coeff_bw; g++) {
         hyd_write_drain_to(&encoder->working_writer, &encoder->hf_coeffs[g]);
-        hyd_freep(&encoder->hf_coeffs[g].buffer);
-        encoder->hf_coeffs[g].buffer_len = 0;
-        if (num_frame_groups > 1) {
+        hyd_bitwriter_release(&encoder->hf_coeffs[g]);
+        if (multi_section) {
             hyd_bitwriter_flush(&encoder->working_writer);
-            encoder->section_endpos[encoder->section_count++] = encoder->working_writer.buffer_pos;
+            encoder->section_endpos[encoder->section_count++] = hyd_bitwriter_tell(&encoder->working_writer);
         }
     }
 
     // write TOC to main buffer
     hyd_bitwriter_flush(&encoder->working_writer);
 
+    /*
+     * The preview and the LF frame go ahead of this one, so they're too big to go straight to output
+     * along with the frame header, and they all go to a writer that the frame is moved to the end of.
+     * With a tile cache, the TOC goes there too, so the frame past its header ends up in one writer.
+     */
+    HYDBitWriter *header_bw = &encoder->writer;
+    const int head_ahead = encoder->metadata.preview || encoder->metadata.lf_frame || encoder->tile_cache;
+    if (head_ahead) {
+        ret = hyd_init_paged_bit_writer(&head_bw, &encoder->page_pool);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        header_bw = &head_bw;
+    }
+    if (encoder->metadata.preview) {
+        ret = write_preview(encoder, &head_bw);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        hyd_freep(&encoder->preview_samples);
+    }
+    if (encoder->metadata.lf_frame) {
+        ret = write_modular_frame(encoder, &head_bw, encoder->lf_frame_samples,
+            hyd_ceil_div(encoder->metadata.width, 8), hyd_ceil_div(encoder->metadata.height, 8), 0);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        hyd_freep(&encoder->lf_frame_samples);
+    }
+
     if (!encoder->wrote_frame_header) {
-        ret = write_frame_header(encoder);
+        ret = write_frame_header(encoder, header_bw);
         if (ret < HYD_ERROR_START)
-            return ret;
+            goto end;
     }
 
-    hyd_write_zero_pad(&encoder->writer);
+    hyd_write_zero_pad(header_bw);
 
-    if (num_frame_groups > 1) {
+    if (multi_section) {
         size_t last_end_pos = 0;
         for (size_t index = 0; index < encoder->section_count; index++) {
-            hyd_write_u32(&encoder->writer, &toc_table, encoder->section_endpos[index] - last_end_pos);
+            hyd_write_u32(header_bw, &toc_table, encoder->section_endpos[index] - last_end_pos);
             last_end_pos = encoder->section_endpos[index];
         }
         encoder->section_count = 0;
     } else {
-        hyd_write_u32(&encoder->writer, &toc_table, encoder->working_writer.buffer_pos);
+        hyd_write_u32(header_bw, &toc_table, hyd_bitwriter_tell(&encoder->working_writer));
+    }
+
+    hyd_write_zero_pad(header_bw);
+
+    if (head_ahead) {
+        ret = hyd_write_drain_to(&head_bw, &encoder->working_writer);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        hyd_bitwriter_release(&encoder->working_writer);
+        encoder->working_writer = head_bw;
+        memset(&head_bw, 0, sizeof(head_bw));
     }
 
-    hyd_write_zero_pad(&encoder->writer);
+    if (encoder->tile_cache)
+        cache_tile(encoder);
 
     encoder->wrote_frame_header = 0;
     ret = hyd_flush(encoder);
-    hyd_entropy_stream_destroy(&encoder->hf_stream);
+    for (unsigned int pass = 0; pass < encoder->num_passes; pass++)
+        hyd_entropy_stream_destroy(&encoder->hf_stream[pass]);
     hyd_free_arraybuffer_p(encoder->section_endpos_array, &encoder->section_endpos);
     hyd_freep(&encoder->hf_stream_barrier);
+    /* tiles at the edges have fewer groups, so the next frame may need more of these */
+    hyd_freep(&encoder->hf_coeffs);
 
 end:
+    hyd_bitwriter_release(&head_bw);
     hyd_freep(&hf_cluster_map);
     hyd_freep(&non_zeroes);
+    hyd_freep(&layouts);
+    hyd_freep(&quant_model);
+    hyd_freep(&tally);
     return ret;
 }
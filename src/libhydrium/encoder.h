@@ -5,7 +5,23 @@
 
 #include "libhydrium/libhydrium.h"
 
+/**
+ * @brief Set the quantizer up for the given distance, between 0.1 and 25.
+ */
+void hyd_set_distance(HYDEncoder *encoder, float distance);
 HYDStatusCode hyd_send_tile_pre(HYDEncoder *encoder, uint32_t tile_x, uint32_t tile_y, int is_last);
+/**
+ * @brief DCT the tile in the XYB buffer in place, which hyd_encode_xyb_buffer then quantizes and codes.
+ */
+void hyd_transform_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t tile_y);
 HYDStatusCode hyd_encode_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t tile_y);
+/**
+ * @brief Write the frame of a tile found in the tile cache, after the header hyd_send_tile_pre wrote.
+ */
+HYDStatusCode hyd_encode_cached_tile(HYDEncoder *encoder);
+/**
+ * @brief Estimate the bytes the tile in the XYB buffer would take, without encoding it.
+ */
+HYDStatusCode hyd_estimate_xyb_buffer(HYDEncoder *encoder, size_t tile_x, size_t tile_y, size_t *size);
 
 #endif /* HYD_ENCODER_H_ */
@@ -1,3 +1,4 @@
+#include <float.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -10,6 +11,10 @@
 #include "memory.h"
 
 #define SF_CHAIN_CAPACITY (1 << 12)
+#define LZ77_HASH_BITS 15
+#define LZ77_WINDOW_SIZE (1 << 20)
+/* rough bits for a histogram in the stream header, by how many symbols it has */
+#define CLUSTER_HEADER_BITS(nonzero) (8.0f * (nonzero) + 32.0f)
 
 // State Flush. Monsieur Bond Wins.
 typedef struct StateFlush {
@@ -24,12 +29,8 @@ typedef struct StateFlushChain {
 } StateFlushChain;
 
 typedef struct FrequencyEntry {
-    int32_t token;
-    uint32_t frequency;
-    int32_t depth;
-    int32_t max_depth;
-    struct FrequencyEntry *left_child;
-    struct FrequencyEntry *right_child;
+    uint64_t frequency;
+    uint32_t token;
 } FrequencyEntry;
 
 static const HYDVLCElement ans_dist_prefix_lengths[14] = {
@@ -39,6 +40,20 @@ static const HYDVLCElement ans_dist_prefix_lengths[14] = {
 
 static const HYDHybridUintConfig lz77_len_conf = {7, 0, 0};
 
+/* (dx, dy) pairs, the distance being dx + dy * dist_multiplier */
+static const int8_t lz77_special_distances[120][2] = {
+    {0, 1},  {1, 0},  {1, 1},  {-1, 1}, {0, 2},  {2, 0},  {1, 2},  {-1, 2}, {2, 1},  {-2, 1}, {2, 2},  {-2, 2},
+    {0, 3},  {3, 0},  {1, 3},  {-1, 3}, {3, 1},  {-3, 1}, {2, 3},  {-2, 3}, {3, 2},  {-3, 2}, {0, 4},  {4, 0},
+    {1, 4},  {-1, 4}, {4, 1},  {-4, 1}, {3, 3},  {-3, 3}, {2, 4},  {-2, 4}, {4, 2},  {-4, 2}, {0, 5},  {3, 4},
+    {-3, 4}, {4, 3},  {-4, 3}, {5, 0},  {1, 5},  {-1, 5}, {5, 1},  {-5, 1}, {2, 5},  {-2, 5}, {5, 2},  {-5, 2},
+    {4, 4},  {-4, 4}, {3, 5},  {-3, 5}, {5, 3},  {-5, 3}, {0, 6},  {1, 6},  {-1, 6}, {6, 0},  {6, 1},  {-6, 1},
+    {2, 6},  {-2, 6}, {6, 2},  {-6, 2}, {4, 5},  {-4, 5}, {5, 4},  {-5, 4}, {3, 6},  {-3, 6}, {6, 3},  {-6, 3},
+    {0, 7},  {1, 7},  {-1, 7}, {5, 5},  {-5, 5}, {7, 0},  {7, 1},  {-7, 1}, {4, 6},  {-4, 6}, {6, 4},  {-6, 4},
+    {2, 7},  {-2, 7}, {7, 2},  {-7, 2}, {3, 7},  {-3, 7}, {7, 3},  {-7, 3}, {5, 6},  {-5, 6}, {6, 5},  {-6, 5},
+    {8, 0},  {4, 7},  {-4, 7}, {7, 4},  {-7, 4}, {8, 1},  {8, 2},  {6, 6},  {-6, 6}, {8, 3},  {5, 7},  {-5, 7},
+    {7, 5},  {-7, 5}, {8, 4},  {6, 7},  {-6, 7}, {7, 6},  {-7, 6}, {8, 5},  {7, 7},  {-7, 7}, {8, 6},  {8, 7},
+};
+
 static const uint32_t prefix_zig_zag[18] = {1, 2, 3, 4, 0, 5, 17, 6, 16, 7, 8, 9, 10, 11, 12, 13, 14, 15};
 
 static const HYDVLCElement prefix_level0_table[6] = {
@@ -82,9 +97,12 @@ void hyd_entropy_stream_destroy(HYDEntropyStream *stream) {
         free(stream->frequencies[i]);
     hyd_free_arraybuffer_p(stream->cluster_map_array, &stream->cluster_map);
     free(stream->symbols);
-    for (size_t i = 0; i < stream->num_clusters; i++)
+    free(stream->symbol_dists);
+    free(stream->lz77_input);
+    for (size_t i = 0; i < stream->num_clusters; i++) {
         hyd_freep(&stream->alias_table[i]);
-    free(stream->vlc_table[0]);
+        hyd_freep(&stream->vlc_table[i]);
+    }
     memset(stream, 0, sizeof(*stream));
 }
 
@@ -383,6 +401,7 @@ HYDStatusCode hyd_entropy_init_stream(HYDEntropyStream *stream, size_t init_symb
         num_dists++;
         stream->lz77_min_length = 3;
         stream->lz77_min_symbol = lz77_min_symbol;
+        stream->lz77_chain_depth = HYD_LZ77_CHAIN_DEPTH;
     }
     stream->num_dists = num_dists;
     stream->modular = modular;
@@ -453,6 +472,12 @@ static HYDStatusCode send_hybridized_symbol(HYDEntropyStream *stream, const HYDH
                 stream->symbol_capacity << 1, sizeof(*stream->symbols));
         if (ret < HYD_ERROR_START)
             return ret;
+        if (stream->symbol_dists) {
+            ret = hyd_realloc_array_p(&stream->symbol_dists,
+                stream->symbol_capacity << 1, sizeof(*stream->symbol_dists));
+            if (ret < HYD_ERROR_START)
+                return ret;
+        }
         stream->symbol_capacity <<= 1;
     }
     stream->symbols[stream->symbol_count++] = *symbol;
@@ -467,60 +492,526 @@ static HYDStatusCode send_entropy_symbol0(HYDEntropyStream *stream, size_t dist,
     HYDHybridSymbol hybrid_symbol;
     hybrid_symbol.cluster = stream->cluster_map[dist];
     hybridize(symbol, &hybrid_symbol, &stream->configs[hybrid_symbol.cluster]);
-    return send_hybridized_symbol(stream, &hybrid_symbol);
+    HYDStatusCode ret = send_hybridized_symbol(stream, &hybrid_symbol);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    if (stream->symbol_dists)
+        stream->symbol_dists[stream->symbol_count - 1] = dist;
+    return HYD_OK;
 }
 
-static HYDStatusCode flush_lz77(HYDEntropyStream *stream) {
-    HYDStatusCode ret;
-    uint32_t last_symbol = stream->last_symbol - 1;
+void hyd_entropy_set_lz77_search(HYDEntropyStream *stream, uint32_t dist_multiplier, uint32_t chain_depth) {
+    stream->lz77_dist_multiplier = dist_multiplier;
+    stream->lz77_chain_depth = chain_depth;
+}
+
+typedef struct LZ77Match {
+    uint32_t length;
+    uint32_t symbol;
+    int64_t savings;
+} LZ77Match;
+
+/* the matches one parse sent, to price the next one */
+typedef struct LZ77Stats {
+    int64_t savings;
+    uint32_t num_matches;
+    uint32_t distance_tokens[256];
+} LZ77Stats;
+
+/* in 1/16 bits. Without literal costs, the longest match wins. */
+typedef struct LZ77Costs {
+    uint64_t *literal;
+    uint32_t length_token;
+    uint32_t distance_token[256];
+} LZ77Costs;
+
+static inline uint32_t lz77_hash(const HYDLZ77Symbol *input) {
+    const uint32_t h = (input[0].symbol * UINT32_C(0x9E3779B1)) ^ (input[1].symbol * UINT32_C(0x85EBCA77))
+        ^ (input[2].symbol * UINT32_C(0xC2B2AE3D));
+    return h >> (32 - LZ77_HASH_BITS);
+}
+
+/* log2(n) in 1/16ths of a bit, linear between powers of two */
+static inline uint32_t log2_16(uint64_t n) {
+    const int fl = hyd_fllog2(n);
+    const uint64_t frac = fl >= 4 ? n >> (fl - 4) : n << (4 - fl);
+    return (fl << 4) + (frac & 0xF);
+}
+
+/* the value the decoder turns back into this distance */
+static uint32_t lz77_distance_symbol(const HYDEntropyStream *stream, uint32_t distance) {
+    if (!stream->modular)
+        return distance - 1;
+    const int64_t mult = stream->lz77_dist_multiplier;
+    for (uint32_t i = 0; i < hyd_array_size(lz77_special_distances); i++) {
+        if (lz77_special_distances[i][1] && !mult)
+            continue;
+        const int64_t special = lz77_special_distances[i][0] + mult * lz77_special_distances[i][1];
+        if (hyd_max(special, 1) == distance)
+            return i;
+    }
+    return distance + 119;
+}
 
-    if (stream->lz77_rle_count > stream->lz77_min_length) {
-        uint32_t repeat_count = stream->lz77_rle_count - stream->lz77_min_length;
+static void lz77_try_match(const HYDEntropyStream *stream, const LZ77Costs *costs, size_t pos,
+        size_t distance, LZ77Match *best) {
+    const HYDLZ77Symbol *input = stream->lz77_input;
+    if (!distance || distance > pos || distance > LZ77_WINDOW_SIZE)
+        return;
+    /* only look further at candidates that can at least outlast the best so far */
+    const size_t reach = pos + best->length;
+    if (best->length && (reach >= stream->lz77_input_count || input[reach].symbol != input[reach - distance].symbol))
+        return;
+    uint32_t length = 0;
+    while (pos + length < stream->lz77_input_count &&
+            input[pos + length].symbol == input[pos + length - distance].symbol)
+        length++;
+    if (length <= stream->lz77_min_length)
+        return;
+    const uint32_t symbol = lz77_distance_symbol(stream, distance);
+    int64_t savings = length;
+    if (costs->literal) {
+        /* the literals it replaces, less both tokens and their residues */
         HYDHybridSymbol hybrid_symbol;
-        hybridize(repeat_count, &hybrid_symbol, &lz77_len_conf);
-        hybrid_symbol.cluster = stream->cluster_map[stream->last_dist];
-        hybrid_symbol.token += stream->lz77_min_symbol;
-        ret = send_hybridized_symbol(stream, &hybrid_symbol);
-        if (ret < HYD_ERROR_START)
-            return ret;
-        ret = send_entropy_symbol0(stream, stream->num_dists - 1, !!stream->modular);
+        hybridize(length - stream->lz77_min_length, &hybrid_symbol, &lz77_len_conf);
+        savings = (int64_t)(costs->literal[pos + length] - costs->literal[pos]) - costs->length_token
+            - (hybrid_symbol.residue_bits << 4);
+        hybridize(symbol, &hybrid_symbol, &stream->configs[stream->cluster_map[stream->num_dists - 1]]);
+        savings -= costs->distance_token[hyd_min(hybrid_symbol.token, 255)] + (hybrid_symbol.residue_bits << 4);
+    }
+    if (savings > best->savings) {
+        best->length = length;
+        best->symbol = symbol;
+        best->savings = savings;
+    }
+}
+
+/* chain up every position before end not already in the hash table */
+static void lz77_insert(const HYDEntropyStream *stream, uint32_t *head, uint32_t *chain, size_t *hashed, size_t end) {
+    for (; *hashed < end && *hashed + 2 < stream->lz77_input_count; (*hashed)++) {
+        const uint32_t hash = lz77_hash(stream->lz77_input + *hashed);
+        /* head and chain store positions plus one, leaving zero for the end of the chain */
+        chain[*hashed] = head[hash];
+        head[hash] = *hashed + 1;
+    }
+}
+
+static void lz77_find(const HYDEntropyStream *stream, const uint32_t *head, const uint32_t *chain,
+        const LZ77Costs *costs, size_t pos, LZ77Match *best) {
+    memset(best, 0, sizeof(*best));
+    lz77_try_match(stream, costs, pos, 1, best);
+    if (stream->modular)
+        lz77_try_match(stream, costs, pos, stream->lz77_dist_multiplier, best);
+    if (pos + 2 >= stream->lz77_input_count)
+        return;
+    uint32_t candidate = head[lz77_hash(stream->lz77_input + pos)];
+    for (uint32_t depth = 0; candidate && depth < stream->lz77_chain_depth; depth++) {
+        lz77_try_match(stream, costs, pos, pos - (candidate - 1), best);
+        candidate = chain[candidate - 1];
+    }
+}
+
+/*
+ * One pass of the hash chain match finder over the buffered symbols. A match is
+ * put off by a literal if the one starting right after it does better.
+ * With stats it only tallies what it would send, otherwise it sends it.
+ */
+static HYDStatusCode lz77_parse(HYDEntropyStream *stream, uint32_t *head, uint32_t *chain,
+        const LZ77Costs *costs, LZ77Stats *stats) {
+    HYDStatusCode ret = HYD_OK;
+    const HYDLZ77Symbol *input = stream->lz77_input;
+    const size_t count = stream->lz77_input_count;
+    const HYDHybridUintConfig *dist_config = &stream->configs[stream->cluster_map[stream->num_dists - 1]];
+    HYDHybridSymbol hybrid_symbol;
+    LZ77Match best, next;
+    int have_next = 0;
+    size_t hashed = 0;
+
+    memset(head, 0, (1 << LZ77_HASH_BITS) * sizeof(*head));
+
+    for (size_t pos = 0; pos < count;) {
+        if (have_next) {
+            best = next;
+            have_next = 0;
+        } else {
+            lz77_insert(stream, head, chain, &hashed, pos);
+            lz77_find(stream, head, chain, costs, pos, &best);
+        }
+        if (best.length && pos + 1 < count) {
+            lz77_insert(stream, head, chain, &hashed, pos + 1);
+            lz77_find(stream, head, chain, costs, pos + 1, &next);
+            if (next.savings > best.savings) {
+                have_next = 1;
+                best.length = 0;
+            }
+        }
+
+        if (best.length && stats) {
+            hybridize(best.symbol, &hybrid_symbol, dist_config);
+            stats->distance_tokens[hyd_min(hybrid_symbol.token, 255)]++;
+            stats->num_matches++;
+            stats->savings += best.savings;
+        } else if (best.length) {
+            hybridize(best.length - stream->lz77_min_length, &hybrid_symbol, &lz77_len_conf);
+            hybrid_symbol.cluster = stream->cluster_map[input[pos].dist];
+            hybrid_symbol.token += stream->lz77_min_symbol;
+            ret = send_hybridized_symbol(stream, &hybrid_symbol);
+            if (ret < HYD_ERROR_START)
+                return ret;
+            ret = send_entropy_symbol0(stream, stream->num_dists - 1, best.symbol);
+        } else if (!stats) {
+            ret = send_entropy_symbol0(stream, input[pos].dist, input[pos].symbol);
+        }
         if (ret < HYD_ERROR_START)
             return ret;
-    } else if (stream->last_symbol && stream->lz77_rle_count) {
-        for (uint32_t k = 0; k < stream->lz77_rle_count; k++) {
-            ret = send_entropy_symbol0(stream, stream->last_dist, last_symbol);
+
+        pos += best.length ? best.length : 1;
+    }
+
+    return ret;
+}
+
+/* literals priced by how often they occur, matches by how the previous parse sent them */
+static void lz77_price(const HYDEntropyStream *stream, const uint32_t *histogram, const LZ77Stats *stats,
+        int prefix, LZ77Costs *costs) {
+    const HYDLZ77Symbol *input = stream->lz77_input;
+    const size_t count = stream->lz77_input_count;
+    /* tokens the previous parse never sent are priced as if sent once */
+    const uint32_t log_total = log2_16(count + stats->num_matches + 1);
+    costs->length_token = log_total - log2_16(stats->num_matches + 1);
+    for (size_t i = 0; i < hyd_array_size(costs->distance_token); i++)
+        costs->distance_token[i] = log2_16(stats->num_matches + 1) - log2_16(stats->distance_tokens[i] + 1);
+    costs->literal[0] = 0;
+    for (size_t pos = 0; pos < count; pos++) {
+        HYDHybridSymbol hybrid_symbol;
+        hybridize(input[pos].symbol, &hybrid_symbol, &stream->configs[stream->cluster_map[input[pos].dist]]);
+        uint32_t cost = log_total - log2_16(histogram[hyd_min(hybrid_symbol.token, stream->lz77_min_symbol - 1)]);
+        /* prefix codes can't spend less than a bit on a symbol */
+        if (prefix)
+            cost = hyd_max(cost, 16);
+        costs->literal[pos + 1] = costs->literal[pos] + cost + (hybrid_symbol.residue_bits << 4);
+    }
+}
+
+/*
+ * Find matches in the buffered symbols and send the result. The first parse
+ * takes the longest matches, and each parse after that keeps only the
+ * matches that pay for themselves at the prices the one before it set.
+ */
+static HYDStatusCode flush_lz77(HYDEntropyStream *stream, int prefix) {
+    HYDStatusCode ret = HYD_OK;
+    uint32_t *head = NULL;
+    uint32_t *chain = NULL;
+    uint32_t *histogram = NULL;
+    LZ77Stats stats = { 0 };
+    LZ77Costs costs = { 0 };
+    const HYDLZ77Symbol *input = stream->lz77_input;
+    const size_t count = stream->lz77_input_count;
+
+    if (!count)
+        return HYD_OK;
+
+    head = hyd_malloc_array(1 << LZ77_HASH_BITS, sizeof(*head));
+    chain = hyd_malloc_array(count, sizeof(*chain));
+    /* literals never tokenize at or above lz77_min_symbol */
+    histogram = calloc(stream->lz77_min_symbol, sizeof(*histogram));
+    costs.literal = hyd_malloc_array(count + 1, sizeof(*costs.literal));
+    if (!head || !chain || !histogram || !costs.literal) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+
+    for (size_t pos = 0; pos < count; pos++) {
+        HYDHybridSymbol hybrid_symbol;
+        hybridize(input[pos].symbol, &hybrid_symbol, &stream->configs[stream->cluster_map[input[pos].dist]]);
+        histogram[hyd_min(hybrid_symbol.token, stream->lz77_min_symbol - 1)]++;
+    }
+
+    LZ77Costs longest = { 0 };
+    ret = lz77_parse(stream, head, chain, &longest, &stats);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    lz77_price(stream, histogram, &stats, prefix, &costs);
+    memset(&stats, 0, sizeof(stats));
+    ret = lz77_parse(stream, head, chain, &costs, &stats);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    if (stats.savings < (int64_t)count << 1) {
+        /* under an eighth of a bit per symbol won't pay for the bigger stream header, so send literals */
+        for (size_t pos = 0; pos < count; pos++) {
+            ret = send_entropy_symbol0(stream, input[pos].dist, input[pos].symbol);
             if (ret < HYD_ERROR_START)
-                return ret;
+                goto end;
         }
+    } else {
+        lz77_price(stream, histogram, &stats, prefix, &costs);
+        ret = lz77_parse(stream, head, chain, &costs, NULL);
+        if (ret < HYD_ERROR_START)
+            goto end;
     }
 
-    stream->lz77_rle_count = 0;
+    stream->lz77_input_count = 0;
 
-    return HYD_OK;
+end:
+    hyd_freep(&head);
+    hyd_freep(&chain);
+    hyd_freep(&histogram);
+    hyd_freep(&costs.literal);
+    return ret;
+}
+
+static HYDStatusCode write_static_symbol(HYDEntropyStream *stream, size_t dist, uint32_t symbol) {
+    HYDHybridSymbol hybrid_symbol;
+    const size_t cluster = stream->cluster_map[dist];
+    hybridize(symbol, &hybrid_symbol, &stream->configs[cluster]);
+    if (hybrid_symbol.token >= stream->alphabet_sizes[cluster]) {
+        *stream->error = "symbol outside of static code";
+        return HYD_INTERNAL_ERROR;
+    }
+    const HYDVLCElement *entry = &stream->vlc_table[cluster][hybrid_symbol.token];
+    hyd_write(stream->static_writer, entry->symbol, entry->length);
+    return hyd_write(stream->static_writer, hybrid_symbol.residue, hybrid_symbol.residue_bits);
+}
+
+uint32_t hyd_entropy_static_bits(const HYDStaticCode *code, uint32_t symbol) {
+    HYDHybridSymbol hybrid_symbol;
+    hybridize(symbol, &hybrid_symbol, &code->config);
+    const uint32_t token = hyd_min(hybrid_symbol.token, code->alphabet_size - 1u);
+    return code->lengths[token] + hybrid_symbol.residue_bits;
+}
+
+uint32_t hyd_entropy_token(const HYDHybridUintConfig *config, uint32_t symbol, uint32_t *residue_bits) {
+    HYDHybridSymbol hybrid_symbol;
+    hybridize(symbol, &hybrid_symbol, config);
+    *residue_bits = hybrid_symbol.residue_bits;
+    return hybrid_symbol.token;
 }
 
 HYDStatusCode hyd_entropy_send_symbol(HYDEntropyStream *stream, size_t dist, uint32_t symbol) {
-    HYDStatusCode ret = HYD_OK;
+    if (stream->static_writer)
+        return write_static_symbol(stream, dist, symbol);
 
     if (!stream->lz77_min_symbol)
         return send_entropy_symbol0(stream, dist, symbol);
 
-    if (stream->last_symbol == symbol + 1 &&
-            stream->cluster_map[stream->last_dist] == stream->cluster_map[dist]) {
-        if (stream->lz77_rle_count < 127) {
-            stream->lz77_rle_count++;
-            return HYD_OK;
+    /* matches are found once everything has been sent, so hold on to the symbols until then */
+    if (stream->lz77_input_count >= stream->lz77_input_capacity) {
+        size_t new_capacity = stream->lz77_input_capacity ? stream->lz77_input_capacity << 1 : stream->symbol_capacity;
+        HYDStatusCode ret = hyd_realloc_array_p(&stream->lz77_input, new_capacity, sizeof(*stream->lz77_input));
+        if (ret < HYD_ERROR_START)
+            return ret;
+        stream->lz77_input_capacity = new_capacity;
+    }
+    stream->lz77_input[stream->lz77_input_count].symbol = symbol;
+    stream->lz77_input[stream->lz77_input_count++].dist = dist;
+
+    return HYD_OK;
+}
+
+HYDStatusCode hyd_entropy_defer_clustering(HYDEntropyStream *stream) {
+    if (stream->symbol_dists)
+        return HYD_OK;
+    return hyd_realloc_array_p(&stream->symbol_dists, stream->symbol_capacity, sizeof(*stream->symbol_dists));
+}
+
+typedef struct HistogramStats {
+    float nlogn;
+    uint32_t total;
+    uint32_t nonzero;
+} HistogramStats;
+
+static void histogram_stats(const uint32_t *histogram, size_t alphabet_size, HistogramStats *stats) {
+    *stats = (HistogramStats){0};
+    for (size_t i = 0; i < alphabet_size; i++) {
+        if (!histogram[i])
+            continue;
+        stats->total += histogram[i];
+        stats->nonzero++;
+        stats->nlogn += histogram[i] * hyd_log2f(histogram[i]);
+    }
+}
+
+/* bits to code a histogram with its own distribution, plus a guess at what its header costs */
+static float histogram_cost(const HistogramStats *stats) {
+    if (!stats->total)
+        return 0.0f;
+    return stats->total * hyd_log2f(stats->total) - stats->nlogn + CLUSTER_HEADER_BITS(stats->nonzero);
+}
+
+float hyd_entropy_histogram_bits(const uint32_t *histogram, size_t alphabet_size) {
+    HistogramStats stats;
+    histogram_stats(histogram, alphabet_size, &stats);
+    return histogram_cost(&stats);
+}
+
+/* histogram_cost of a + b, only visiting the symbols a has */
+static float merged_cost(const uint32_t *a, const HistogramStats *a_stats,
+        const uint32_t *b, const HistogramStats *b_stats, size_t alphabet_size) {
+    HistogramStats merged = *b_stats;
+    merged.total += a_stats->total;
+    for (size_t i = 0; i < alphabet_size; i++) {
+        if (!a[i])
+            continue;
+        if (b[i])
+            merged.nlogn -= b[i] * hyd_log2f(b[i]);
+        else
+            merged.nonzero++;
+        merged.nlogn += (a[i] + b[i]) * hyd_log2f(a[i] + b[i]);
+    }
+    return histogram_cost(&merged);
+}
+
+/*
+ * Seeds the clusters farthest point first: the busiest dist, then whichever
+ * dist would cost the most to merge into any cluster so far, until that stops
+ * paying for another header. Every dist then joins the cluster it's cheapest
+ * to add to, the clusters are rebuilt from their members, and they join again.
+ */
+HYDStatusCode hyd_entropy_cluster(HYDEntropyStream *stream, size_t dist_from, size_t num_dists,
+        size_t max_clusters, size_t *clusters_used) {
+    HYDStatusCode ret = HYD_OK;
+    const size_t alphabet_size = stream->max_alphabet_size;
+    const size_t base = stream->cluster_map[dist_from];
+    uint32_t *histograms = NULL;
+    uint32_t *centers = NULL;
+    HistogramStats *stats = NULL;
+    HistogramStats *center_stats = NULL;
+    float *nearest = NULL;
+    uint8_t *members = NULL;
+    size_t num_centers = 0;
+
+    if (!stream->symbol_dists) {
+        *stream->error = "clustering was not deferred";
+        return HYD_INTERNAL_ERROR;
+    }
+    max_clusters = hyd_clamp(max_clusters, 1, 256 - base);
+
+    histograms = calloc(num_dists * alphabet_size, sizeof(*histograms));
+    centers = calloc(max_clusters * alphabet_size, sizeof(*centers));
+    stats = hyd_malloc_array(num_dists, sizeof(*stats));
+    center_stats = hyd_malloc_array(max_clusters, sizeof(*center_stats));
+    nearest = hyd_malloc_array(num_dists, sizeof(*nearest));
+    members = calloc(num_dists, sizeof(*members));
+    if (!histograms || !centers || !stats || !center_stats || !nearest || !members) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+
+    for (size_t i = 0; i < stream->symbol_count; i++) {
+        const size_t d = stream->symbol_dists[i] - dist_from;
+        if (d < num_dists)
+            histograms[d * alphabet_size + stream->symbols[i].token]++;
+    }
+
+    size_t busiest = num_dists;
+    float busiest_cost = 0.0f;
+    for (size_t d = 0; d < num_dists; d++) {
+        histogram_stats(histograms + d * alphabet_size, alphabet_size, &stats[d]);
+        const float cost = histogram_cost(&stats[d]);
+        /* empty dists never seed a cluster */
+        nearest[d] = stats[d].total ? FLT_MAX : -FLT_MAX;
+        if (cost > busiest_cost) {
+            busiest_cost = cost;
+            busiest = d;
         }
     }
 
-    ret = flush_lz77(stream);
-    if (ret < HYD_ERROR_START)
-        return ret;
+    for (size_t next = busiest; next < num_dists && num_centers < max_clusters; num_centers++) {
+        const uint32_t *seed = histograms + next * alphabet_size;
+        memcpy(centers + num_centers * alphabet_size, seed, alphabet_size * sizeof(*centers));
+        center_stats[num_centers] = stats[next];
+        const float seed_cost = histogram_cost(&stats[next]);
+        float farthest = 0.0f;
+        next = num_dists;
+        for (size_t d = 0; d < num_dists; d++) {
+            if (nearest[d] == -FLT_MAX)
+                continue;
+            const float distance = merged_cost(histograms + d * alphabet_size, &stats[d],
+                seed, &center_stats[num_centers], alphabet_size) - histogram_cost(&stats[d]) - seed_cost;
+            nearest[d] = hyd_min(nearest[d], distance);
+            if (nearest[d] > farthest) {
+                farthest = nearest[d];
+                next = d;
+            }
+        }
+    }
+    num_centers = hyd_max(num_centers, 1);
 
-    stream->last_symbol = symbol + 1;
-    stream->last_dist = dist;
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t d = 0; d < num_dists; d++) {
+            if (nearest[d] == -FLT_MAX)
+                continue;
+            float best = FLT_MAX;
+            for (size_t c = 0; c < num_centers; c++) {
+                const float added = merged_cost(histograms + d * alphabet_size, &stats[d],
+                    centers + c * alphabet_size, &center_stats[c], alphabet_size) - histogram_cost(&center_stats[c]);
+                if (added < best) {
+                    best = added;
+                    members[d] = c;
+                }
+            }
+        }
+        if (pass)
+            break;
+        memset(centers, 0, num_centers * alphabet_size * sizeof(*centers));
+        for (size_t d = 0; d < num_dists; d++) {
+            uint32_t *center = centers + members[d] * alphabet_size;
+            for (size_t i = 0; i < alphabet_size; i++)
+                center[i] += histograms[d * alphabet_size + i];
+        }
+        for (size_t c = 0; c < num_centers; c++)
+            histogram_stats(centers + c * alphabet_size, alphabet_size, &center_stats[c]);
+    }
 
-    return send_entropy_symbol0(stream, dist, symbol);
+    /* number the clusters anyone joined in order of first appearance, with empty dists in the first */
+    uint8_t renumber[256];
+    memset(renumber, 0xFF, sizeof(renumber));
+    size_t num_used = 0;
+    for (size_t d = 0; d < num_dists; d++) {
+        if (nearest[d] != -FLT_MAX && renumber[members[d]] == 0xFF)
+            renumber[members[d]] = num_used++;
+    }
+    num_used = hyd_max(num_used, 1);
+    for (size_t d = 0; d < num_dists; d++) {
+        const uint8_t c = nearest[d] == -FLT_MAX ? 0 : renumber[members[d]];
+        stream->cluster_map[dist_from + d] = base + c;
+    }
+    for (size_t d = dist_from + num_dists; d < stream->num_dists && base + num_used < 256; d++) {
+        if (stream->cluster_map[d] == base)
+            stream->cluster_map[d] = base + num_used;
+    }
+
+    for (size_t c = base; c < base + num_used; c++) {
+        stream->alphabet_sizes[c] = 0;
+        stream->configs[c] = stream->configs[base];
+    }
+    for (size_t i = 0; i < stream->symbol_count; i++) {
+        const size_t d = stream->symbol_dists[i];
+        if (d - dist_from >= num_dists)
+            continue;
+        HYDHybridSymbol *symbol = &stream->symbols[i];
+        symbol->cluster = stream->cluster_map[d];
+        stream->alphabet_sizes[symbol->cluster] = hyd_max(symbol->token + 1, stream->alphabet_sizes[symbol->cluster]);
+    }
+    stream->num_clusters = hyd_max(stream->num_clusters, base + num_used);
+    *clusters_used = num_used;
+
+end:
+    hyd_freep(&histograms);
+    hyd_freep(&centers);
+    hyd_freep(&stats);
+    hyd_freep(&center_stats);
+    hyd_freep(&nearest);
+    hyd_freep(&members);
+    return ret;
+}
+
+/* no hybrid uint config can split above the ANS alphabet */
+static int ans_log_alphabet_size(const HYDEntropyStream *stream) {
+    int log_alphabet_size = hyd_max(hyd_cllog2(stream->max_alphabet_size), 5);
+    for (size_t i = 0; i < stream->num_clusters; i++)
+        log_alphabet_size = hyd_max(log_alphabet_size, stream->configs[i].split_exponent);
+    return log_alphabet_size;
 }
 
 static HYDStatusCode count_frequencies(HYDEntropyStream *stream, size_t cluster_from, size_t cluster_to,
@@ -547,9 +1038,6 @@ static HYDStatusCode stream_header_common(HYDEntropyStream *stream, HYDBitWriter
     HYDStatusCode ret = HYD_OK;
     hyd_write_bool(bw, stream->lz77_min_symbol);
     if (stream->lz77_min_symbol) {
-        ret = flush_lz77(stream);
-        if (ret < HYD_ERROR_START)
-            return ret;
         hyd_write_u32(bw, &min_symbol_table, stream->lz77_min_symbol);
         hyd_write_u32(bw, &min_length_table, stream->lz77_min_length);
         ret = write_hybrid_uint_config(bw, &lz77_len_conf, 8);
@@ -574,90 +1062,114 @@ static HYDStatusCode stream_header_common(HYDEntropyStream *stream, HYDBitWriter
     return bw->overflow_state;
 }
 
-static inline int huffman_compare(const FrequencyEntry *fa, const FrequencyEntry *fb) {
-    return fa->frequency != fb->frequency ?
-        (!fb->frequency ? -1 : !fa->frequency ? 1 : fa->frequency - fb->frequency) :
-        (!fb->token ? -1 : !fa->token ? 1 : fa->token - fb->token);
-}
-
-static int32_t collect(FrequencyEntry *entry) {
-    if (!entry)
-        return 0;
-    int32_t self = ++entry->depth;
-    int32_t left = collect(entry->left_child);
-    int32_t right = collect(entry->right_child);
-    return entry->max_depth = hyd_max3(self, left, right);
+static int huffman_compare(const void *a, const void *b) {
+    const FrequencyEntry *fa = a;
+    const FrequencyEntry *fb = b;
+    if (fa->frequency != fb->frequency)
+        return fa->frequency < fb->frequency ? -1 : 1;
+    return fa->token < fb->token ? -1 : fa->token > fb->token;
 }
 
+/*
+ * Optimal length-limited code lengths via package-merge.
+ * Level 0 holds the leaves sorted by frequency; every later level merges
+ * the leaves with pairs packaged from the level before it. Only the first
+ * 2 * nz - 2 items of any level can ever be selected, so each level is
+ * truncated to that size and we only record which merged items were packages.
+ * Walking back down, each leaf selected at a level deepens its code by one.
+ */
 static HYDStatusCode build_huffman_tree(HYDEntropyStream *stream, const uint32_t *frequencies,
                                         uint32_t *lengths, uint32_t alphabet_size, int32_t max_depth) {
     HYDStatusCode ret = HYD_OK;
-    FrequencyEntry *tree = calloc((2 * alphabet_size - 1), sizeof(*tree));
-    if (!tree) {
+    FrequencyEntry *leaves = NULL;
+    uint64_t *weights = NULL;
+    uint8_t *is_package = NULL;
+
+    if (max_depth < 0)
+        max_depth = hyd_cllog2(alphabet_size + 1);
+
+    leaves = hyd_malloc_array(alphabet_size, sizeof(*leaves));
+    if (!leaves) {
         ret = HYD_NOMEM;
         goto end;
     }
 
     uint32_t nz = 0;
     for (uint32_t token = 0; token < alphabet_size; token++) {
-        tree[token].frequency = frequencies[token];
-        tree[token].token = 1 + token;
-        tree[token].left_child = tree[token].right_child = NULL;
-        if (frequencies[token])
-            nz++;
+        lengths[token] = 0;
+        if (!frequencies[token])
+            continue;
+        leaves[nz].frequency = frequencies[token];
+        leaves[nz++].token = token;
     }
     if (!nz) {
         *stream->error = "No nonzero frequencies";
         ret = HYD_INTERNAL_ERROR;
         goto end;
     }
+    if (nz == 1)
+        goto end;
+    if (max_depth > 31 || nz > UINT32_C(1) << max_depth) {
+        *stream->error = "couldn't find target";
+        ret = HYD_INTERNAL_ERROR;
+        goto end;
+    }
 
-    if (max_depth < 0)
-        max_depth = hyd_cllog2(alphabet_size + 1);
+    qsort(leaves, nz, sizeof(*leaves), &huffman_compare);
 
-    for (uint32_t k = 0; k < alphabet_size - 1; k++, nz--) {
-        int32_t smallest = -1;
-        int32_t second = -1;
-        int32_t target = max_depth - hyd_cllog2(nz) + 1;
-        for (uint32_t j = 2 * k; j < alphabet_size + k; j++) {
-            if (!tree[j].frequency)
-                continue;
-            if (tree[j].max_depth >= target)
-                continue;
-            if (smallest < 0 || huffman_compare(&tree[j], &tree[smallest]) < 0) {
-                second = smallest;
-                smallest = j;
-            } else if (second < 0 || huffman_compare(&tree[j], &tree[second]) < 0) {
-                second = j;
+    const size_t list_max = 2 * nz - 2;
+    weights = hyd_malloc_array(2 * list_max, sizeof(*weights));
+    is_package = hyd_malloc_array(max_depth * list_max, sizeof(*is_package));
+    if (!weights || !is_package) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+
+    uint64_t *prev = weights;
+    uint64_t *cur = weights + list_max;
+    size_t prev_len = hyd_min(nz, list_max);
+    for (size_t j = 0; j < prev_len; j++) {
+        prev[j] = leaves[j].frequency;
+        is_package[j] = 0;
+    }
+    memset(is_package + prev_len, 0, list_max - prev_len);
+
+    for (int32_t level = 1; level < max_depth; level++) {
+        uint8_t *flags = is_package + level * list_max;
+        const size_t num_packages = prev_len >> 1;
+        size_t l = 0, p = 0, len = 0;
+        while (len < list_max && (l < nz || p < num_packages)) {
+            const uint64_t package = p < num_packages ? prev[2 * p] + prev[2 * p + 1] : UINT64_MAX;
+            if (l < nz && leaves[l].frequency <= package) {
+                cur[len] = leaves[l++].frequency;
+                flags[len++] = 0;
+            } else {
+                cur[len] = package;
+                flags[len++] = 1;
+                p++;
             }
         }
-        if (smallest < 0) {
-            *stream->error = "couldn't find target";
-            ret = HYD_INTERNAL_ERROR;
-            goto end;
-        }
-        hyd_swap(FrequencyEntry, tree[smallest], tree[2 * k]);
-        if (second < 0)
-            break;
-        if (second == 2 * k)
-            second = smallest;
-        smallest = 2 * k;
-        hyd_swap(FrequencyEntry, tree[second], tree[2 * k + 1]);
-        second = smallest + 1;
-        FrequencyEntry *entry = &tree[alphabet_size + k];
-        entry->frequency = tree[smallest].frequency + tree[second].frequency;
-        entry->left_child = &tree[smallest];
-        entry->right_child = &tree[second];
-        collect(entry);
+        uint64_t *temp = prev;
+        prev = cur;
+        cur = temp;
+        prev_len = len;
     }
 
-    for (uint32_t j = 0; j < 2 * alphabet_size - 1; j++) {
-        if (tree[j].token)
-            lengths[tree[j].token - 1] = tree[j].depth;
+    size_t take = list_max;
+    for (int32_t level = max_depth - 1; level >= 0 && take; level--) {
+        const uint8_t *flags = is_package + level * list_max;
+        size_t num_leaves = 0;
+        for (size_t j = 0; j < take; j++)
+            num_leaves += !flags[j];
+        for (size_t j = 0; j < num_leaves; j++)
+            lengths[leaves[j].token]++;
+        take = 2 * (take - num_leaves);
     }
 
 end:
-    free(tree);
+    hyd_freep(&leaves);
+    hyd_freep(&weights);
+    hyd_freep(&is_package);
     return ret;
 }
 
@@ -706,6 +1218,57 @@ end:
     return ret;
 }
 
+HYDStatusCode hyd_entropy_init_static_stream(HYDEntropyStream *stream, const uint8_t *cluster_map, size_t num_dists,
+        const HYDStaticCode *codes, const char **error) {
+    HYDStatusCode ret;
+    uint32_t lengths[1 << 8];
+    memset(stream, 0, sizeof(HYDEntropyStream));
+    stream->error = error;
+    stream->num_dists = num_dists;
+    stream->coding = HYD_CODING_PREFIX;
+    ret = hyd_malloc_arraybuffer_p(num_dists, sizeof(*stream->cluster_map), stream->cluster_map_array,
+        sizeof(stream->cluster_map_array), &stream->cluster_map);
+    if (ret < HYD_ERROR_START)
+        goto fail;
+    memcpy(stream->cluster_map, cluster_map, num_dists);
+    for (size_t i = 0; i < num_dists; i++) {
+        if (stream->cluster_map[i] >= stream->num_clusters)
+            stream->num_clusters = stream->cluster_map[i] + 1;
+    }
+
+    for (size_t i = 0; i < stream->num_clusters; i++) {
+        const HYDStaticCode *code = &codes[i];
+        if (code->alphabet_size > hyd_array_size(lengths)) {
+            *stream->error = "static code alphabet too large";
+            ret = HYD_INTERNAL_ERROR;
+            goto fail;
+        }
+        stream->configs[i] = code->config;
+        stream->alphabet_sizes[i] = code->alphabet_size;
+        stream->max_alphabet_size = hyd_max(stream->max_alphabet_size, code->alphabet_size);
+        stream->vlc_table[i] = calloc(code->alphabet_size, sizeof(HYDVLCElement));
+        if (!stream->vlc_table[i]) {
+            ret = HYD_NOMEM;
+            goto fail;
+        }
+        for (size_t j = 0; j < code->alphabet_size; j++)
+            lengths[j] = code->lengths[j];
+        ret = build_prefix_table(stream, stream->vlc_table[i], lengths, code->alphabet_size);
+        if (ret < HYD_ERROR_START)
+            goto fail;
+    }
+
+    return HYD_OK;
+
+fail:
+    hyd_entropy_stream_destroy(stream);
+    return ret;
+}
+
+void hyd_entropy_set_static_writer(HYDEntropyStream *stream, HYDBitWriter *bw) {
+    stream->static_writer = bw;
+}
+
 static void flush_zeroes(HYDBitWriter *bw, const HYDVLCElement *level1_table, uint32_t num_zeroes) {
     if (num_zeroes >= 3) {
         int32_t k = 0;
@@ -762,9 +1325,22 @@ static HYDStatusCode write_complex_prefix_lengths(HYDEntropyStream *stream, HYDB
     if (ret < HYD_ERROR_START)
         goto end;
 
+    /*
+     * A lone level1 symbol has a zero-bit code, but the decoder
+     * still has to see it with a nonzero length to accept it.
+     */
+    uint32_t level1_nz = 0;
+    uint32_t level1_lone = 0;
+    for (uint32_t j = 0; j < 18; j++) {
+        if (level1_freqs[j]) {
+            level1_nz++;
+            level1_lone = j;
+        }
+    }
+
     uint32_t total_code = 0;
     for (uint32_t j = 0; j < 18; j++) {
-        uint32_t code = level1_lengths[prefix_zig_zag[j]];
+        uint32_t code = level1_nz == 1 ? prefix_zig_zag[j] == level1_lone : level1_lengths[prefix_zig_zag[j]];
         hyd_write(bw, prefix_level0_table[code].symbol,
                       prefix_level0_table[code].length);
         if (code)
@@ -772,7 +1348,7 @@ static HYDStatusCode write_complex_prefix_lengths(HYDEntropyStream *stream, HYDB
         if (total_code >= 32)
             break;
     }
-    if (total_code && total_code != 32) {
+    if (level1_nz > 1 && total_code != 32) {
         *stream->error = "level1 code total mismatch";
         ret = HYD_INTERNAL_ERROR;
         goto end;
@@ -804,34 +1380,64 @@ end:
     return ret;
 }
 
-HYDStatusCode hyd_prefix_write_stream_header(HYDEntropyStream *stream, HYDBitWriter *bw) {
+HYDStatusCode hyd_prefix_prepare_tables(HYDEntropyStream *stream, size_t cluster_from, size_t cluster_to,
+        size_t symbol_from, size_t symbol_count)
+{
     HYDStatusCode ret;
     uint32_t *lengths = NULL;
-    HYDVLCElement *vlc_table = NULL;
 
-    ret = stream_header_common(stream, bw, 0);
+    ret = count_frequencies(stream, cluster_from, cluster_to, symbol_from, symbol_count);
     if (ret < HYD_ERROR_START)
         goto fail;
 
-    ret = count_frequencies(stream, 0, stream->num_clusters, 0, stream->symbol_count);
+    lengths = hyd_malloc_array(stream->max_alphabet_size, sizeof(uint32_t));
+    if (!lengths) {
+        ret = HYD_NOMEM;
+        goto fail;
+    }
+
+    for (size_t i = cluster_from; i < stream->num_clusters && i < cluster_to; i++) {
+        const uint32_t alphabet_size = stream->alphabet_sizes[i];
+        if (!alphabet_size)
+            continue;
+        stream->vlc_table[i] = calloc(alphabet_size, sizeof(HYDVLCElement));
+        if (!stream->vlc_table[i]) {
+            ret = HYD_NOMEM;
+            goto fail;
+        }
+        if (alphabet_size <= 1)
+            continue;
+        ret = build_huffman_tree(stream, stream->frequencies[i], lengths, alphabet_size, 15);
+        if (ret < HYD_ERROR_START)
+            goto fail;
+        ret = build_prefix_table(stream, stream->vlc_table[i], lengths, alphabet_size);
+        if (ret < HYD_ERROR_START)
+            goto fail;
+    }
+
+    free(lengths);
+    return HYD_OK;
+
+fail:
+    free(lengths);
+    hyd_entropy_stream_destroy(stream);
+    return ret;
+}
+
+HYDStatusCode hyd_prefix_write_stream_header(HYDEntropyStream *stream, HYDBitWriter *bw) {
+    HYDStatusCode ret;
+    uint32_t *lengths = NULL;
+
+    ret = stream_header_common(stream, bw, 0);
     if (ret < HYD_ERROR_START)
         goto fail;
 
     lengths = hyd_malloc_array(stream->max_alphabet_size, sizeof(uint32_t));
-    size_t total_alphabet_size = 0;
-    for (size_t i = 0; i < stream->num_clusters; i++)
-        total_alphabet_size += stream->alphabet_sizes[i];
-
-    vlc_table = calloc(total_alphabet_size, sizeof(HYDVLCElement));
-    if (!vlc_table) {
+    if (!lengths) {
         ret = HYD_NOMEM;
         goto fail;
     }
 
-    stream->vlc_table[0] = vlc_table;
-    for (size_t i = 0; i < stream->num_clusters - 1; i++)
-        stream->vlc_table[i + 1] = stream->vlc_table[i] + stream->alphabet_sizes[i];
-
     for (size_t i = 0; i < stream->num_clusters; i++) {
         if (stream->alphabet_sizes[i] <= 1) {
             hyd_write_bool(bw, 0);
@@ -847,30 +1453,22 @@ HYDStatusCode hyd_prefix_write_stream_header(HYDEntropyStream *stream, HYDBitWri
         const uint32_t alphabet_size = stream->alphabet_sizes[i];
         if (alphabet_size <= 1)
             continue;
-        const uint32_t *freqs = stream->frequencies[i];
-        memset(lengths, 0, stream->max_alphabet_size * sizeof(uint32_t));
-        HYDVLCElement *table = stream->vlc_table[i];
-        ret = build_huffman_tree(stream, freqs, lengths, alphabet_size, 15);
-        if (ret < HYD_ERROR_START)
-            goto fail;
+        const HYDVLCElement *table = stream->vlc_table[i];
         uint32_t nsym = 0;
         HYDVLCElement tokens[4] = { 0 };
         for (uint32_t j = 0; j < alphabet_size; j++) {
-            if (!lengths[j])
+            lengths[j] = table[j].length;
+            if (!lengths[j] || nsym > 4)
                 continue;
             if (nsym < 4) {
                 tokens[nsym].symbol = j;
                 tokens[nsym].length = lengths[j];
             }
-            if (++nsym > 4)
-                break;
+            nsym++;
         }
 
         if (nsym > 4) {
             ret = write_complex_prefix_lengths(stream, bw, alphabet_size, lengths);
-            if (ret < HYD_ERROR_START)
-                goto fail;
-            ret = build_prefix_table(stream, table, lengths, alphabet_size);
             if (ret < HYD_ERROR_START)
                 goto fail;
             continue;
@@ -921,9 +1519,6 @@ HYDStatusCode hyd_prefix_write_stream_header(HYDEntropyStream *stream, HYDBitWri
             hyd_write(bw, tokens[n].symbol, log_alphabet_size);
         if (nsym == 4)
             hyd_write_bool(bw, tree_select);
-        ret = build_prefix_table(stream, table, lengths, alphabet_size);
-        if (ret < HYD_ERROR_START)
-            goto fail;
     }
 
     free(lengths);
@@ -932,10 +1527,6 @@ HYDStatusCode hyd_prefix_write_stream_header(HYDEntropyStream *stream, HYDBitWri
 
 fail:
     free(lengths);
-    free(vlc_table);
-    /* stream->vlc_table[0] might == vlc_table */
-    /* but zero it anyway so we don't double free below */
-    stream->vlc_table[0] = NULL;
     hyd_entropy_stream_destroy(stream);
     return ret;
 }
@@ -949,7 +1540,7 @@ HYDStatusCode hyd_ans_prepare_frequencies(HYDEntropyStream *stream, size_t clust
     if (ret < HYD_ERROR_START)
         goto fail;
 
-    int log_alphabet_size = hyd_max(hyd_cllog2(stream->max_alphabet_size), 5);
+    const int log_alphabet_size = ans_log_alphabet_size(stream);
 
     for (size_t i = cluster_from; i < stream->num_clusters && i < cluster_to; i++) {
         if (!stream->alphabet_sizes[i])
@@ -981,7 +1572,7 @@ HYDStatusCode hyd_ans_write_stream_header(HYDEntropyStream *stream, HYDBitWriter
 
     HYDStatusCode ret;
 
-    ret = stream_header_common(stream, bw,  hyd_max(hyd_cllog2(stream->max_alphabet_size), 5));
+    ret = stream_header_common(stream, bw, ans_log_alphabet_size(stream));
     if (ret < HYD_ERROR_START)
         goto fail;
 
@@ -1008,29 +1599,41 @@ HYDStatusCode hyd_prefix_write_stream_symbols(HYDEntropyStream *stream, HYDBitWr
         return HYD_INTERNAL_ERROR;
     }
 
+    /*
+     * code and residue are fused into one word (at most 15 + 32 bits)
+     * and batched in a local accumulator, which is only handed to the
+     * bit writer once it can't take another symbol. Space is reserved
+     * per chunk so the hand-off is unchecked whenever the writer can grow.
+     */
     const HYDHybridSymbol *symbols = stream->symbols + symbol_start;
-    for (size_t p = 0; p < symbol_count; p++) {
-        size_t cluster = symbols[p].cluster;
-        uint32_t token = symbols[p].token;
-        const HYDVLCElement *entry = &stream->vlc_table[cluster][token];
-        hyd_write(bw, entry->symbol, entry->length);
-        hyd_write(bw, symbols[p].residue, symbols[p].residue_bits);
+    uint64_t batch = 0;
+    int batch_bits = 0;
+    for (size_t chunk = 0; chunk < symbol_count; chunk += 256) {
+        const size_t chunk_end = hyd_min(chunk + 256, symbol_count);
+        const int reserved = hyd_write_reserve(bw, (chunk_end - chunk) * 47 + batch_bits) == HYD_OK;
+        for (size_t p = chunk; p < chunk_end; p++) {
+            const HYDVLCElement *entry = &stream->vlc_table[symbols[p].cluster][symbols[p].token];
+            const uint64_t fused = (uint64_t)entry->symbol | ((uint64_t)symbols[p].residue << entry->length);
+            const int fused_bits = entry->length + symbols[p].residue_bits;
+            if (batch_bits + fused_bits > 56) {
+                if (reserved)
+                    hyd_write_fast(bw, batch, batch_bits);
+                else
+                    hyd_write(bw, batch, batch_bits);
+                batch = 0;
+                batch_bits = 0;
+            }
+            batch |= fused << batch_bits;
+            batch_bits += fused_bits;
+        }
     }
 
-    return bw->overflow_state;
+    return hyd_write(bw, batch, batch_bits);
 }
 
 HYDStatusCode hyd_prefix_finalize_stream(HYDEntropyStream *stream, HYDBitWriter *bw) {
-    HYDStatusCode ret = hyd_prefix_write_stream_header(stream, bw);
-    if (ret < HYD_ERROR_START)
-        goto end;
-    ret = hyd_prefix_write_stream_symbols(stream, bw, 0, stream->symbol_count);
-    if (ret < HYD_ERROR_START)
-        goto end;
-
-end:
-    hyd_entropy_stream_destroy(stream);
-    return ret;
+    stream->coding = HYD_CODING_PREFIX;
+    return hyd_entropy_finalize_stream(stream, bw);
 }
 
 static HYDStatusCode append_state_flush(StateFlushChain **flushes, uint16_t diff, uint16_t value) {
@@ -1070,7 +1673,7 @@ HYDStatusCode hyd_ans_write_stream_symbols(HYDEntropyStream *stream, HYDBitWrite
         ret = HYD_NOMEM;
         goto end;
     }
-    const int log_alphabet_size = hyd_max(hyd_cllog2(stream->max_alphabet_size), 5);
+    const int log_alphabet_size = ans_log_alphabet_size(stream);
     const uint32_t log_bucket_size = 12 - log_alphabet_size;
     const uint32_t pos_mask = ~(~UINT32_C(0) << log_bucket_size);
 
@@ -1132,18 +1735,28 @@ HYDStatusCode hyd_ans_write_stream_symbols(HYDEntropyStream *stream, HYDBitWrite
         goto end;
 
     size_t last_pop = 0;
+    int reserved = 0;
     for (size_t p = 0; p < symbol_count; p++) {
+        /* each symbol writes at most one 16-bit flush and a 32-bit residue */
+        if (!(p & 0xFF))
+            reserved = hyd_write_reserve(bw, 48 * hyd_min(symbol_count - p, 256) + 32) == HYD_OK;
         const StateFlush *flush;
         while ((flush = pop_state_flush(&flushes))) {
             if (p - last_pop >= flush->diff) {
-                hyd_write(bw, flush->value, 16);
+                if (reserved)
+                    hyd_write_fast(bw, flush->value, 16);
+                else
+                    hyd_write(bw, flush->value, 16);
                 last_pop = p;
             } else {
                 flushes->pos++;
                 break;
             }
         }
-        hyd_write(bw, symbols[p].residue, symbols[p].residue_bits);
+        if (reserved)
+            hyd_write_fast(bw, symbols[p].residue, symbols[p].residue_bits);
+        else
+            hyd_write(bw, symbols[p].residue, symbols[p].residue_bits);
     }
 
     ret = bw->overflow_state;
@@ -1159,14 +1772,143 @@ end:
 }
 
 HYDStatusCode hyd_ans_finalize_stream(HYDEntropyStream *stream, HYDBitWriter *bw) {
+    stream->coding = HYD_CODING_ANS;
+    return hyd_entropy_finalize_stream(stream, bw);
+}
+
+/*
+ * Bits the clusters in range would take as prefix codes and with ANS, from the raw counts
+ * in stream->frequencies. Both include the histograms in the stream header, where simple
+ * codes and ANS tables are priced exactly and complex prefix code lengths are a guess.
+ * Residues cost the same either way, so they're left out.
+ */
+static HYDStatusCode estimate_coding_costs(HYDEntropyStream *stream, size_t cluster_from, size_t cluster_to,
+        float *prefix_cost, float *ans_cost) {
+    HYDStatusCode ret = HYD_OK;
+    uint32_t *lengths = hyd_malloc_array(stream->max_alphabet_size, sizeof(*lengths));
+    uint32_t *ans_frequencies = hyd_malloc_array(stream->max_alphabet_size, sizeof(*ans_frequencies));
+    if (!lengths || !ans_frequencies) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+
+    *prefix_cost = 0.0f;
+    *ans_cost = 0.0f;
+    for (size_t i = cluster_from; i < stream->num_clusters && i < cluster_to; i++) {
+        const uint32_t alphabet_size = stream->alphabet_sizes[i];
+        const uint32_t *frequencies = stream->frequencies[i];
+        if (alphabet_size <= 1) {
+            *prefix_cost += 1.0f;
+            *ans_cost += 10.0f;
+            continue;
+        }
+
+        ret = build_huffman_tree(stream, frequencies, lengths, alphabet_size, 15);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        uint32_t nsym = 0;
+        for (uint32_t j = 0; j < alphabet_size; j++) {
+            nsym += !!frequencies[j];
+            *prefix_cost += (float)frequencies[j] * lengths[j];
+        }
+        *prefix_cost += 5 + hyd_fllog2(alphabet_size - 1);
+        *prefix_cost += nsym > 4 ? 40 + 4 * nsym : 4 + nsym * hyd_cllog2(alphabet_size) + (nsym == 4);
+
+        memcpy(ans_frequencies, frequencies, alphabet_size * sizeof(*ans_frequencies));
+        if (calculate_ans_frequencies(ans_frequencies, alphabet_size)) {
+            *ans_cost += 10.0f;
+            continue;
+        }
+        uint32_t omit_log = 0;
+        *ans_cost += 16.0f;
+        for (uint32_t j = 0; j < alphabet_size; j++) {
+            const uint32_t log_count = ans_frequencies[j] ? 1 + hyd_fllog2(ans_frequencies[j]) : 0;
+            *ans_cost += ans_dist_prefix_lengths[log_count].length + (log_count > 1 ? log_count - 1 : 0);
+            omit_log = hyd_max(omit_log, log_count);
+            if (frequencies[j])
+                *ans_cost += frequencies[j] * (12.0f - hyd_log2f(ans_frequencies[j]));
+        }
+        *ans_cost -= omit_log > 1 ? omit_log - 1 : 0;
+    }
+
+end:
+    hyd_freep(&lengths);
+    hyd_freep(&ans_frequencies);
+    return ret;
+}
+
+void hyd_entropy_set_coding(HYDEntropyStream *stream, HYDEntropyCoding coding) {
+    stream->coding = coding;
+}
+
+static HYDStatusCode select_coding(HYDEntropyStream *stream, size_t cluster_from, size_t cluster_to,
+        size_t symbol_from, size_t symbol_count) {
+    /* ANS alphabets stop at 256 */
+    if (stream->max_alphabet_size > 256) {
+        stream->coding = HYD_CODING_PREFIX;
+        return HYD_OK;
+    }
+
+    HYDStatusCode ret = count_frequencies(stream, cluster_from, cluster_to, symbol_from, symbol_count);
+    if (ret < HYD_ERROR_START)
+        return ret;
+    float prefix_cost, ans_cost;
+    ret = estimate_coding_costs(stream, cluster_from, cluster_to, &prefix_cost, &ans_cost);
+    if (ret < HYD_ERROR_START)
+        return ret;
+
+    /* for fast decoding, ANS has to win by an eighth */
+    const float margin = stream->coding == HYD_CODING_FAST_DECODE ? prefix_cost * 0.125f : 0.0f;
+    stream->coding = ans_cost + margin < prefix_cost ? HYD_CODING_ANS : HYD_CODING_PREFIX;
+
+    return HYD_OK;
+}
+
+HYDStatusCode hyd_entropy_prepare_stream(HYDEntropyStream *stream, size_t cluster_from, size_t cluster_to,
+        size_t symbol_from, size_t symbol_count) {
+    HYDStatusCode ret;
+    if (stream->coding == HYD_CODING_AUTO || stream->coding == HYD_CODING_FAST_DECODE) {
+        ret = select_coding(stream, cluster_from, cluster_to, symbol_from, symbol_count);
+        if (ret < HYD_ERROR_START) {
+            hyd_entropy_stream_destroy(stream);
+            return ret;
+        }
+    }
+    if (stream->coding == HYD_CODING_PREFIX)
+        return hyd_prefix_prepare_tables(stream, cluster_from, cluster_to, symbol_from, symbol_count);
+    return hyd_ans_prepare_frequencies(stream, cluster_from, cluster_to, symbol_from, symbol_count);
+}
+
+HYDStatusCode hyd_entropy_write_stream_header(HYDEntropyStream *stream, HYDBitWriter *bw) {
+    if (stream->coding == HYD_CODING_PREFIX)
+        return hyd_prefix_write_stream_header(stream, bw);
+    return hyd_ans_write_stream_header(stream, bw);
+}
+
+HYDStatusCode hyd_entropy_write_stream_symbols(HYDEntropyStream *stream, HYDBitWriter *bw,
+        size_t symbol_start, size_t symbol_count) {
+    if (stream->coding == HYD_CODING_PREFIX)
+        return hyd_prefix_write_stream_symbols(stream, bw, symbol_start, symbol_count);
+    return hyd_ans_write_stream_symbols(stream, bw, symbol_start, symbol_count);
+}
+
+HYDStatusCode hyd_entropy_finalize_stream(HYDEntropyStream *stream, HYDBitWriter *bw) {
     HYDStatusCode ret;
-    ret = hyd_ans_prepare_frequencies(stream, 0, stream->num_clusters, 0, stream->symbol_count);
+    if (stream->static_writer) {
+        ret = stream->static_writer->overflow_state;
+        goto end;
+    }
+    /* matches are priced before the coding is picked, so guess at it */
+    ret = flush_lz77(stream, stream->coding != HYD_CODING_ANS);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    ret = hyd_entropy_prepare_stream(stream, 0, stream->num_clusters, 0, stream->symbol_count);
     if (ret < HYD_ERROR_START)
         goto end;
-    ret = hyd_ans_write_stream_header(stream, bw);
+    ret = hyd_entropy_write_stream_header(stream, bw);
     if (ret < HYD_ERROR_START)
         goto end;
-    ret = hyd_ans_write_stream_symbols(stream, bw, 0, stream->symbol_count);
+    ret = hyd_entropy_write_stream_symbols(stream, bw, 0, stream->symbol_count);
     if (ret < HYD_ERROR_START)
         goto end;
 
@@ -6,6 +6,9 @@
 
 #include "bitwriter.h"
 
+/* hash chain candidates checked per position by the LZ77 match finder */
+#define HYD_LZ77_CHAIN_DEPTH 32
+
 typedef struct HYDHybridSymbol {
     uint16_t token;
     uint8_t cluster;
@@ -20,17 +23,39 @@ typedef struct HYDAliasEntry {
     int32_t original[256];
 } HYDAliasEntry;
 
+typedef struct HYDLZ77Symbol {
+    uint32_t symbol;
+    uint32_t dist;
+} HYDLZ77Symbol;
+
 typedef struct HYDHybridUintConfig {
     uint8_t split_exponent;
     uint8_t msb_in_token;
     uint8_t lsb_in_token;
 } HYDHybridUintConfig;
 
+/* a fixed prefix code, for streams that don't look at their symbols before writing them */
+typedef struct HYDStaticCode {
+    HYDHybridUintConfig config;
+    uint16_t alphabet_size;
+    /* code length of every token, which must add up to a complete code */
+    const uint8_t *lengths;
+} HYDStaticCode;
+
 typedef struct HYDVLCElement {
     int32_t symbol;
     uint32_t length;
 } HYDVLCElement;
 
+typedef enum HYDEntropyCoding {
+    /* whichever looks smaller, picked the first time the stream is prepared */
+    HYD_CODING_AUTO,
+    /* the same, but ANS has to be quite a bit smaller to beat prefix codes */
+    HYD_CODING_FAST_DECODE,
+    HYD_CODING_PREFIX,
+    HYD_CODING_ANS,
+} HYDEntropyCoding;
+
 typedef struct HYDEntropyStream {
     size_t num_dists;
     uint8_t cluster_map_array[64];
@@ -40,18 +65,25 @@ typedef struct HYDEntropyStream {
     HYDHybridSymbol *symbols;
     size_t symbol_count;
     size_t symbol_capacity;
+    // only when clustering is deferred, the dist each symbol was sent with
+    uint32_t *symbol_dists;
     uint32_t *frequencies[256];
     uint16_t alphabet_sizes[256];
     uint16_t max_alphabet_size;
     HYDHybridUintConfig configs[256];
+    HYDEntropyCoding coding;
     int wrote_stream_header;
+    // static codes only, where symbols go as they're sent
+    HYDBitWriter *static_writer;
 
     // lz77 only
     uint32_t lz77_min_length;
     uint32_t lz77_min_symbol;
-    uint32_t last_symbol;
-    uint32_t last_dist;
-    uint32_t lz77_rle_count;
+    uint32_t lz77_dist_multiplier;
+    uint32_t lz77_chain_depth;
+    HYDLZ77Symbol *lz77_input;
+    size_t lz77_input_count;
+    size_t lz77_input_capacity;
     int modular;
 
     // prefix only
@@ -67,11 +99,91 @@ typedef struct HYDEntropyStream {
 HYDStatusCode hyd_entropy_init_stream(HYDEntropyStream *stream, size_t init_symbol_count, const uint8_t *cluster_map,
         size_t num_dists, int custom_configs, uint32_t lz77_min_symbol, int modular, const char **error);
 
+/**
+ * @brief Initialize a stream that codes with the given prefix codes, one per cluster, instead of
+ * codes built from its symbols. It never buffers symbols: once hyd_entropy_set_static_writer is called,
+ * each symbol is written out as it is sent. The stream header can be written before or after that.
+ * @return HYD_OK upon success, negative upon error.
+ */
+HYDStatusCode hyd_entropy_init_static_stream(HYDEntropyStream *stream, const uint8_t *cluster_map, size_t num_dists,
+        const HYDStaticCode *codes, const char **error);
+
+/**
+ * @brief Send the symbols of a static stream to bw from now on.
+ */
+void hyd_entropy_set_static_writer(HYDEntropyStream *stream, HYDBitWriter *bw);
+
+/**
+ * @brief How many bits code spends on symbol, counting the raw bits after its token. Symbols
+ * past the end of the code get the length of its last token, as an estimate.
+ */
+uint32_t hyd_entropy_static_bits(const HYDStaticCode *code, uint32_t symbol);
+
+/**
+ * @brief The token config codes symbol with, with the number of raw bits after it in residue_bits.
+ */
+uint32_t hyd_entropy_token(const HYDHybridUintConfig *config, uint32_t symbol, uint32_t *residue_bits);
+
+/**
+ * @brief Bits to code a histogram of tokens with its own distribution, plus a guess at what its header costs.
+ */
+float hyd_entropy_histogram_bits(const uint32_t *histogram, size_t alphabet_size);
+
 HYDStatusCode hyd_entropy_set_hybrid_config(HYDEntropyStream *stream, uint8_t min_cluster, uint8_t to_cluster,
         int split_exponent, int msb_in_token, int lsb_in_token);
 
+/**
+ * @brief Tune the LZ77 match finder of a stream with LZ77 enabled.
+ * @param dist_multiplier The widest channel for modular streams, which unlocks the 2D special distances,
+ * or zero if it's unknown.
+ * @param chain_depth How many earlier matches of the same hash to check per position. Zero only tries
+ * the previous symbol and the one above.
+ */
+void hyd_entropy_set_lz77_search(HYDEntropyStream *stream, uint32_t dist_multiplier, uint32_t chain_depth);
+
 HYDStatusCode hyd_entropy_send_symbol(HYDEntropyStream *stream, size_t dist, uint32_t symbol);
 
+/**
+ * @brief Remember the dist of every symbol sent from here on, so hyd_entropy_cluster can regroup them.
+ * @return HYD_OK upon success, negative upon error.
+ */
+HYDStatusCode hyd_entropy_defer_clustering(HYDEntropyStream *stream);
+
+/**
+ * @brief Cluster the dists [dist_from, dist_from + num_dists) by the histograms of the symbols sent so far.
+ * They must all share one cluster and one hybrid uint config to start with. They get up to max_clusters
+ * clusters numbered from that one, and any later dists still sharing it move to the first cluster past those.
+ * @param clusters_used Set to the number of clusters they ended up with.
+ * @return HYD_OK upon success, negative upon error.
+ */
+HYDStatusCode hyd_entropy_cluster(HYDEntropyStream *stream, size_t dist_from, size_t num_dists,
+    size_t max_clusters, size_t *clusters_used);
+
+/**
+ * @brief Pick prefix codes or ANS for the stream, or leave it at HYD_CODING_AUTO to let the first
+ * hyd_entropy_prepare_stream call decide from the symbols it counts.
+ */
+void hyd_entropy_set_coding(HYDEntropyStream *stream, HYDEntropyCoding coding);
+
+/**
+ * @brief hyd_prefix_prepare_tables or hyd_ans_prepare_frequencies, whichever the stream codes with.
+ * @return HYD_OK upon success, negative upon error.
+ */
+HYDStatusCode hyd_entropy_prepare_stream(HYDEntropyStream *stream, size_t cluster_from, size_t cluster_to,
+    size_t symbol_from, size_t symbol_count);
+HYDStatusCode hyd_entropy_write_stream_header(HYDEntropyStream *stream, HYDBitWriter *bw);
+HYDStatusCode hyd_entropy_write_stream_symbols(HYDEntropyStream *stream, HYDBitWriter *bw,
+    size_t symbol_start, size_t symbol_count);
+
+/**
+ * @brief prepare_stream, write_stream_header, write_stream_symbols, and entropy_stream_destroy in one function.
+ * A static stream has already written its symbols, so it's only destroyed.
+ * @return HYDStatusCode HYD_OK upon success, negative upon error.
+ */
+HYDStatusCode hyd_entropy_finalize_stream(HYDEntropyStream *stream, HYDBitWriter *bw);
+
+HYDStatusCode hyd_prefix_prepare_tables(HYDEntropyStream *stream, size_t cluster_from, size_t cluster_to,
+    size_t symbol_from, size_t symbol_count);
 HYDStatusCode hyd_prefix_write_stream_header(HYDEntropyStream *stream, HYDBitWriter *bw);
 HYDStatusCode hyd_prefix_write_stream_symbols(HYDEntropyStream *stream, HYDBitWriter *bw,
     size_t symbol_start, size_t symbol_count);
@@ -4,6 +4,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "libhydrium/libhydrium.h"
@@ -82,24 +83,50 @@ static HYDStatusCode populate_output_lut(float **lut, const size_t size) {
     return HYD_OK;
 }
 
+/* when upsampling, each coded pixel sums up the input pixels it covers, and average_xyb divides them out */
+static inline void store_xyb(XYBEntry *entry, const HYD_vec3_f32 xyb, const int shift) {
+    if (shift) {
+        entry->xyb[0].f += xyb.v0;
+        entry->xyb[1].f += xyb.v1;
+        entry->xyb[2].f += xyb.v2;
+    } else {
+        entry->xyb[0].f = xyb.v0;
+        entry->xyb[1].f = xyb.v1;
+        entry->xyb[2].f = xyb.v2;
+    }
+}
+
+static void average_xyb(HYDEncoder *encoder, const HYDLFGroup *lfg) {
+    const int shift = encoder->upsampling_shift;
+    for (size_t y = 0; y < lfg->height; y++) {
+        const size_t rows = hyd_min(lfg->input_height - (y << shift), (size_t)1 << shift);
+        for (size_t x = 0; x < lfg->width; x++) {
+            const size_t cols = hyd_min(lfg->input_width - (x << shift), (size_t)1 << shift);
+            const float scale = 1.f / (rows * cols);
+            XYBEntry *entry = &encoder->xyb[y * lfg->stride + x];
+            entry->xyb[0].f *= scale;
+            entry->xyb[1].f *= scale;
+            entry->xyb[2].f *= scale;
+        }
+    }
+}
+
 #define process_lut(type_) \
 static inline HYDStatusCode process_lut_ ## type_ (HYDEncoder *encoder, const type_ *const buffer[3], \
         ptrdiff_t row_stride, ptrdiff_t pixel_stride, const HYDLFGroup *lfg, \
         const uint16_t *input_lut, const float *bias_lut) { \
-    for (size_t y = 0; y < lfg->height; y++) { \
+    const int shift = encoder->upsampling_shift; \
+    for (size_t y = 0; y < lfg->input_height; y++) { \
         const ptrdiff_t y_off = y * row_stride; \
-        const size_t row = y * lfg->stride; \
-        for (size_t x = 0; x < lfg->width; x++) { \
+        const size_t row = (y >> shift) * lfg->stride; \
+        for (size_t x = 0; x < lfg->input_width; x++) { \
             const ptrdiff_t offset = y_off + x * pixel_stride; \
             HYD_vec3_u16 rgbu16; \
             rgbu16.v0 = input_lut[buffer[0][offset]]; \
             rgbu16.v1 = input_lut[buffer[1][offset]]; \
             rgbu16.v2 = input_lut[buffer[2][offset]]; \
             HYD_vec3_f32 xyb = rgb_to_xyb_u16(bias_lut, rgbu16); \
-            XYBEntry *entry = &encoder->xyb[row + x]; \
-            entry->xyb[0].f = xyb.v0; \
-            entry->xyb[1].f = xyb.v1; \
-            entry->xyb[2].f = xyb.v2; \
+            store_xyb(&encoder->xyb[row + (x >> shift)], xyb, shift); \
         } \
     } \
     return HYD_OK; \
@@ -111,10 +138,11 @@ process_lut(uint16_t)
 static inline HYDStatusCode process_lut_float(HYDEncoder *encoder, const float *const buffer[3],
         ptrdiff_t row_stride, ptrdiff_t pixel_stride, const HYDLFGroup *lfg,
         const int need_linearize) {
-    for (size_t y = 0; y < lfg->height; y++) {
+    const int shift = encoder->upsampling_shift;
+    for (size_t y = 0; y < lfg->input_height; y++) {
         const ptrdiff_t y_off = y * row_stride;
-        const size_t row = y * lfg->stride;
-        for (size_t x = 0; x < lfg->width; x++) {
+        const size_t row = (y >> shift) * lfg->stride;
+        for (size_t x = 0; x < lfg->input_width; x++) {
             const ptrdiff_t offset = y_off + x * pixel_stride;
             HYD_vec3_f32 rgbf32;
             rgbf32.v0 = buffer[0][offset];
@@ -130,21 +158,32 @@ static inline HYDStatusCode process_lut_float(HYDEncoder *encoder, const float *
                 rgbf32.v2 = linearize(rgbf32.v2);
             }
             HYD_vec3_f32 xyb = rgb_to_xyb_f32(rgbf32);
-            XYBEntry *entry = &encoder->xyb[row + x];
-            entry->xyb[0].f = xyb.v0;
-            entry->xyb[1].f = xyb.v1;
-            entry->xyb[2].f = xyb.v2;
+            store_xyb(&encoder->xyb[row + (x >> shift)], xyb, shift);
         }
     }
     return HYD_OK;
 }
 
+void hyd_pad_xyb_buffer(HYDEncoder *encoder, size_t lf_group_id) {
+    const HYDLFGroup *lfg = &encoder->lfg[lf_group_id];
+    const size_t residue_x = 8 - (lfg->width & 0x7u);
+    if (residue_x != 8) {
+        for (size_t y = 0; y < lfg->height; y++) {
+            const size_t row = y * lfg->stride;
+            memset(encoder->xyb + row + lfg->width, 0, residue_x * sizeof(XYBEntry));
+        }
+    }
+    const size_t residue_y = 8 - (lfg->height & 0x7u);
+    if (residue_y != 8)
+        memset(encoder->xyb + lfg->height * lfg->stride, 0, residue_y * lfg->stride * sizeof(XYBEntry));
+}
+
 HYDStatusCode hyd_populate_xyb_buffer(HYDEncoder *encoder, const void *const buffer[3],
         ptrdiff_t row_stride, ptrdiff_t pixel_stride, size_t lf_group_id,
         HYDSampleFormat sample_fmt) {
     int need_linearize = !encoder->metadata.linear_light;
-    const uint16_t *input_lut;
-    const float *bias_lut;
+    const uint16_t *input_lut = NULL;
+    const float *bias_lut = NULL;
     HYDStatusCode ret;
     if (sample_fmt == HYD_UINT8 || sample_fmt == HYD_UINT16) {
         uint16_t **lutss = sample_fmt == HYD_UINT8 ? &encoder->input_lut8 : &encoder->input_lut16;
@@ -159,6 +198,8 @@ HYDStatusCode hyd_populate_xyb_buffer(HYDEncoder *encoder, const void *const buf
         bias_lut = encoder->bias_cbrtf_lut;
     }
     const HYDLFGroup *lfg = &encoder->lfg[lf_group_id];
+    if (encoder->upsampling_shift)
+        memset(encoder->xyb, 0, lfg->height * lfg->stride * sizeof(XYBEntry));
     switch (sample_fmt) {
         case HYD_UINT8: {
             const uint8_t *const buf8[3] = { buffer[0], buffer[1], buffer[2] };
@@ -179,16 +220,162 @@ HYDStatusCode hyd_populate_xyb_buffer(HYDEncoder *encoder, const void *const buf
             encoder->error = "Invalid Sample Format";
             return HYD_API_ERROR;
     }
-    const size_t residue_x = 8 - (lfg->width & 0x7u);
-    if (residue_x != 8) {
-        for (size_t y = 0; y < lfg->height; y++) {
-            const size_t row = y * lfg->stride;
-            memset(encoder->xyb + row + lfg->width, 0, residue_x * sizeof(XYBEntry));
+    if (encoder->upsampling_shift)
+        average_xyb(encoder, lfg);
+    hyd_pad_xyb_buffer(encoder, lf_group_id);
+
+    return HYD_OK;
+}
+
+/* mix v into the tile hash h, spreading each of its bits over the whole word */
+static inline uint64_t hash_step(uint64_t h, uint64_t v) {
+    h = (h ^ v) * UINT64_C(0x9E3779B97F4A7C15);
+    return h ^ (h >> 29);
+}
+
+#define hash_tile(type_, bits_) \
+static uint64_t hash_tile_ ## type_ (const type_ *const buffer[3], ptrdiff_t row_stride, \
+        ptrdiff_t pixel_stride, const HYDLFGroup *lfg, uint64_t h) { \
+    for (size_t y = 0; y < lfg->input_height; y++) { \
+        const ptrdiff_t y_off = y * row_stride; \
+        for (size_t x = 0; x < lfg->input_width; x++) { \
+            const ptrdiff_t offset = y_off + x * pixel_stride; \
+            h = hash_step(h, buffer[0][offset] | (uint64_t)buffer[1][offset] << (bits_) \
+                | (uint64_t)buffer[2][offset] << (2 * (bits_))); \
+        } \
+    } \
+    return h; \
+}
+
+hash_tile(uint8_t, 8)
+hash_tile(uint16_t, 16)
+
+static uint64_t hash_tile_float(const float *const buffer[3], ptrdiff_t row_stride,
+        ptrdiff_t pixel_stride, const HYDLFGroup *lfg, uint64_t h) {
+    for (size_t y = 0; y < lfg->input_height; y++) {
+        const ptrdiff_t y_off = y * row_stride;
+        for (size_t x = 0; x < lfg->input_width; x++) {
+            const ptrdiff_t offset = y_off + x * pixel_stride;
+            union { float f; uint32_t i; } r = { buffer[0][offset] }, g = { buffer[1][offset] },
+                b = { buffer[2][offset] };
+            h = hash_step(h, r.i | (uint64_t)g.i << 32);
+            h = hash_step(h, b.i);
         }
     }
-    const size_t residue_y = 8 - (lfg->height & 0x7u);
-    if (residue_y != 8)
-        memset(encoder->xyb + lfg->height * lfg->stride, 0, residue_y * lfg->stride * sizeof(XYBEntry));
+    return h;
+}
+
+uint64_t hyd_hash_tile(const HYDEncoder *encoder, const void *const buffer[3], ptrdiff_t row_stride,
+        ptrdiff_t pixel_stride, size_t lf_group_id, HYDSampleFormat sample_fmt) {
+    const HYDLFGroup *lfg = &encoder->lfg[lf_group_id];
+    uint64_t h = hash_step(hash_step(sample_fmt, lfg->input_width), lfg->input_height);
+    switch (sample_fmt) {
+        case HYD_UINT8: {
+            const uint8_t *const buf8[3] = { buffer[0], buffer[1], buffer[2] };
+            return hash_tile_uint8_t(buf8, row_stride, pixel_stride, lfg, h);
+        }
+        case HYD_UINT16: {
+            const uint16_t *const buf16[3] = { buffer[0], buffer[1], buffer[2] };
+            return hash_tile_uint16_t(buf16, row_stride, pixel_stride, lfg, h);
+        }
+        default: {
+            const float *const buf32[3] = { buffer[0], buffer[1], buffer[2] };
+            return hash_tile_float(buf32, row_stride, pixel_stride, lfg, h);
+        }
+    }
+}
+
+static size_t sample_size(HYDSampleFormat sample_fmt) {
+    return sample_fmt == HYD_UINT8 ? 1 : sample_fmt == HYD_UINT16 ? 2 : 4;
+}
+
+/* copy the LF group's input samples to or from packed, or compare them with it, returning 0 on a mismatch */
+static int pack_tile(const void *const buffer[3], ptrdiff_t row_stride, ptrdiff_t pixel_stride,
+        const HYDLFGroup *lfg, size_t size, uint8_t *packed, int compare) {
+    for (size_t y = 0; y < lfg->input_height; y++) {
+        const ptrdiff_t y_off = y * row_stride;
+        for (size_t x = 0; x < lfg->input_width; x++) {
+            const ptrdiff_t offset = (y_off + x * pixel_stride) * (ptrdiff_t)size;
+            for (int c = 0; c < 3; c++) {
+                const uint8_t *sample = (const uint8_t *)buffer[c] + offset;
+                if (!compare)
+                    memcpy(packed, sample, size);
+                else if (memcmp(packed, sample, size))
+                    return 0;
+                packed += size;
+            }
+        }
+    }
+    return 1;
+}
 
+void hyd_store_tile_samples(const HYDEncoder *encoder, HYDCachedTile *slot, const void *const buffer[3],
+        ptrdiff_t row_stride, ptrdiff_t pixel_stride, size_t lf_group_id, HYDSampleFormat sample_fmt) {
+    const HYDLFGroup *lfg = &encoder->lfg[lf_group_id];
+    const size_t size = sample_size(sample_fmt);
+    /* the slot's frame goes with the samples being replaced */
+    slot->size = 0;
+    if (hyd_realloc_p(&slot->samples, lfg->input_width * lfg->input_height * 3 * size) < HYD_ERROR_START) {
+        hyd_freep(&slot->samples);
+        return;
+    }
+    pack_tile(buffer, row_stride, pixel_stride, lfg, size, slot->samples, 0);
+    slot->width = lfg->input_width;
+    slot->height = lfg->input_height;
+    slot->sample_fmt = sample_fmt;
+}
+
+int hyd_tile_samples_match(const HYDEncoder *encoder, const HYDCachedTile *slot, const void *const buffer[3],
+        ptrdiff_t row_stride, ptrdiff_t pixel_stride, size_t lf_group_id, HYDSampleFormat sample_fmt) {
+    const HYDLFGroup *lfg = &encoder->lfg[lf_group_id];
+    if (!slot->samples || slot->sample_fmt != sample_fmt || slot->width != lfg->input_width
+            || slot->height != lfg->input_height)
+        return 0;
+    return pack_tile(buffer, row_stride, pixel_stride, lfg, sample_size(sample_fmt),
+        slot->samples, 1);
+}
+
+HYDStatusCode hyd_populate_preview(HYDEncoder *encoder, size_t lf_group_id) {
+    if (!encoder->preview_samples) {
+        encoder->preview_samples = calloc(encoder->preview_width * encoder->preview_height,
+            sizeof(*encoder->preview_samples));
+        if (!encoder->preview_samples)
+            return HYD_NOMEM;
+    }
+    /* preview mode is one-frame mode, so LF groups are 2048x2048 coded pixels */
+    const HYDLFGroup *lfg = &encoder->lfg[lf_group_id];
+    const int shift = encoder->preview_shift;
+    for (size_t y = 0; y < lfg->height; y++) {
+        const size_t row = ((lfg->y << 11) + y) >> shift;
+        XYBEntry *preview = &encoder->preview_samples[row * encoder->preview_width];
+        for (size_t x = 0; x < lfg->width; x++) {
+            const XYBEntry *xyb = &encoder->xyb[y * lfg->stride + x];
+            XYBEntry *entry = &preview[((lfg->x << 11) + x) >> shift];
+            entry->xyb[0].f += xyb->xyb[0].f;
+            entry->xyb[1].f += xyb->xyb[1].f;
+            entry->xyb[2].f += xyb->xyb[2].f;
+        }
+    }
     return HYD_OK;
 }
+
+void hyd_populate_pyramid(HYDEncoder *encoder) {
+    /* pyramids are tiled, so this is the only LF group */
+    const HYDLFGroup *lfg = encoder->lfg;
+    const size_t tile_h = lfg->tile_count_y << 8;
+    const size_t x0 = lfg->x * (lfg->tile_count_x << 8);
+    const size_t y0 = lfg->y * tile_h;
+    for (int k = 1; k <= encoder->pyramid_levels; k++) {
+        const HYDPyramidLevel *level = &encoder->pyramid[k - 1];
+        for (size_t y = 0; y < lfg->height; y++) {
+            XYBEntry *row = &level->row[(((y0 + y) >> k) % tile_h) * level->width];
+            for (size_t x = 0; x < lfg->width; x++) {
+                const XYBEntry *xyb = &encoder->xyb[y * lfg->stride + x];
+                XYBEntry *entry = &row[(x0 + x) >> k];
+                entry->xyb[0].f += xyb->xyb[0].f;
+                entry->xyb[1].f += xyb->xyb[1].f;
+                entry->xyb[2].f += xyb->xyb[2].f;
+            }
+        }
+    }
+}
@@ -13,8 +13,26 @@ typedef struct HYD_vec3_u16 {
     uint16_t v0, v1, v2;
 } HYD_vec3_u16;
 
+/* one slot of the tile cache, in internal.h */
+typedef struct HYDCachedTile HYDCachedTile;
+
 HYDStatusCode hyd_populate_xyb_buffer(HYDEncoder *encoder, const void *const buffer[3],
     ptrdiff_t row_stride, ptrdiff_t pixel_stride, size_t lf_group_id,
     HYDSampleFormat sample_fmt);
+/* a hash of the LF group's input samples, its size, and their format, which tiles that code alike share */
+uint64_t hyd_hash_tile(const HYDEncoder *encoder, const void *const buffer[3], ptrdiff_t row_stride,
+    ptrdiff_t pixel_stride, size_t lf_group_id, HYDSampleFormat sample_fmt);
+/* keep a copy of the LF group's input samples in the cache slot, leaving the slot empty if that fails */
+void hyd_store_tile_samples(const HYDEncoder *encoder, HYDCachedTile *slot, const void *const buffer[3],
+    ptrdiff_t row_stride, ptrdiff_t pixel_stride, size_t lf_group_id, HYDSampleFormat sample_fmt);
+/* whether the LF group's input samples are the ones kept in the cache slot */
+int hyd_tile_samples_match(const HYDEncoder *encoder, const HYDCachedTile *slot, const void *const buffer[3],
+    ptrdiff_t row_stride, ptrdiff_t pixel_stride, size_t lf_group_id, HYDSampleFormat sample_fmt);
+/* add the coded pixels of the LF group in the XYB buffer to the preview pixels they fall under */
+HYDStatusCode hyd_populate_preview(HYDEncoder *encoder, size_t lf_group_id);
+/* add the coded pixels of the tile in the XYB buffer to the pixels they fall under in each pyramid level */
+void hyd_populate_pyramid(HYDEncoder *encoder);
+/* zero the XYB buffer past the edges of the LF group, out to whole varblocks */
+void hyd_pad_xyb_buffer(HYDEncoder *encoder, size_t lf_group_id);
 
 #endif /* HYD_FORMAT_H_ */
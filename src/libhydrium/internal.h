@@ -14,6 +14,8 @@ typedef struct HYDLFGroup {
     size_t tile_count_x, tile_count_y;
     size_t x, y;
     size_t width, height;
+    /* width and height in input pixels, which is larger when upsampling */
+    size_t input_width, input_height;
     size_t varblock_width, varblock_height;
     size_t stride;
 } HYDLFGroup;
@@ -25,6 +27,27 @@ typedef struct XYBEntry {
     } xyb[3];
 } XYBEntry;
 
+/* one level of a pyramid, of which only the current row of tiles is kept */
+typedef struct HYDPyramidLevel {
+    /* the sum of the coded pixels under each pixel of the row, in raster order, and then their average */
+    XYBEntry *row;
+    size_t width, height;
+    /* the row of tiles being filled, and how many tiles of the image have gone into it */
+    size_t row_y;
+    size_t tiles_in;
+} HYDPyramidLevel;
+
+/* one slot of the tile cache, holding a tile's frame from the end of its header on */
+struct HYDCachedTile {
+    uint64_t key;
+    uint8_t *data;
+    size_t size;
+    /* the tile's input samples, packed, to tell it apart from others with the same hash */
+    uint8_t *samples;
+    size_t width, height;
+    HYDSampleFormat sample_fmt;
+};
+
 typedef struct HFBarrier {
     size_t barrier_index;
     uint8_t preset;
@@ -33,7 +56,8 @@ typedef struct HFBarrier {
 /* opaque structure */
 struct HYDEncoder {
     HYDImageMetadata metadata;
-    HYDEntropyStream hf_stream;
+    /* one for each pass */
+    HYDEntropyStream hf_stream[3];
 
     XYBEntry *xyb;
 
@@ -56,6 +80,46 @@ struct HYDEncoder {
     HYDBitWriter writer;
     HYDBitWriter working_writer;
     size_t copy_pos;
+    HYDWriterPagePool page_pool;
+
+    /* quantizer settings picked from metadata.distance */
+    uint32_t global_scale;
+    uint32_t quant_lf;
+    uint16_t hf_mult;
+    /* the HF multiplier of each block in the current LF group, in raster order */
+    uint8_t *hf_mult_field;
+    /* XFromY and BFromY of each 64x64 tile in the current LF group, in raster order */
+    int8_t cfl_factors[2][1024];
+    /* the AC strategy of each block in the current LF group, or 0xFF past the first block of a varblock */
+    uint8_t *ac_strategy;
+    /* metadata.effort, with 0 resolved to the default */
+    int effort;
+    /* whether HF coefficients go through quantize_rdo, which is from effort 2 up */
+    int rdo_quant;
+    /* bytes the image should fit in, or 0 to go by metadata.distance */
+    size_t target_size;
+    /* log2 of metadata.upsampling, which frames are coded smaller by */
+    int upsampling_shift;
+    /* with metadata.lf_frame, the quantized LF of the whole image, in raster order, until it's written */
+    XYBEntry *lf_frame_samples;
+    /* with metadata.preview, the sum of the coded pixels under each preview pixel, in raster order */
+    XYBEntry *preview_samples;
+    /* log2 of how many times smaller the preview is than the coded image */
+    int preview_shift;
+    size_t preview_width, preview_height;
+    /* with hyd_set_pyramid, the levels below the image, each half the size of the one before it */
+    HYDPyramidLevel *pyramid;
+    int pyramid_levels;
+    HYDPyramidCallback pyramid_callback;
+    void *pyramid_opaque;
+    /* with hyd_set_tile_cache, the most recent frame whose tile hashes to each slot */
+    HYDCachedTile *tile_cache;
+    size_t tile_cache_slots;
+    /* the hash of the tile being sent, with a tile cache, and whether it's in the cache */
+    uint64_t tile_key;
+    int tile_cached;
+    /* metadata.passes, with 0 resolved to 1 */
+    unsigned int num_passes;
 
     int wrote_header;
     int wrote_frame_header;
@@ -78,8 +142,13 @@ struct HYDEncoder {
     uint8_t *icc_data;
     size_t icc_size;
 
+    /* one for each group of each pass, pass by pass */
     HYDBitWriter *hf_coeffs;
     size_t num_hf_coeff_bw;
+
+    /* natural_order indices of each channel's HF coefficients, in the order they're scanned */
+    uint8_t coeff_order[3][64];
+    int custom_coeff_order;
 };
 
 HYDStatusCode hyd_populate_lf_group(HYDEncoder *encoder, HYDLFGroup **lf_group, uint32_t tile_x, uint32_t tile_y);
@@ -12,32 +12,57 @@
 #include "internal.h"
 #include "math-functions.h"
 #include "memory.h"
+#include "static-codes.h"
 
 HYDRIUM_EXPORT HYDEncoder *hyd_encoder_new(void) {
     HYDEncoder *ret = calloc(1, sizeof(HYDEncoder));
     return ret;
 }
 
+static void free_pyramid(HYDEncoder *encoder) {
+    for (int k = 0; encoder->pyramid && k < encoder->pyramid_levels; k++)
+        hyd_freep(&encoder->pyramid[k].row);
+    hyd_freep(&encoder->pyramid);
+    encoder->pyramid_levels = 0;
+}
+
+static void free_tile_cache(HYDEncoder *encoder) {
+    for (size_t i = 0; encoder->tile_cache && i < encoder->tile_cache_slots; i++) {
+        hyd_freep(&encoder->tile_cache[i].data);
+        hyd_freep(&encoder->tile_cache[i].samples);
+    }
+    hyd_freep(&encoder->tile_cache);
+    encoder->tile_cache_slots = 0;
+}
+
 HYDRIUM_EXPORT HYDStatusCode hyd_encoder_destroy(HYDEncoder *encoder) {
     if (!encoder)
         return HYD_OK;
 
-    hyd_entropy_stream_destroy(&encoder->hf_stream);
+    for (int p = 0; p < 3; p++)
+        hyd_entropy_stream_destroy(&encoder->hf_stream[p]);
     hyd_free_arraybuffer_p(encoder->section_endpos_array, &encoder->section_endpos);
     hyd_freep(&encoder->hf_stream_barrier);
-    hyd_freep(&encoder->working_writer.buffer);
+    hyd_bitwriter_release(&encoder->working_writer);
     hyd_freep(&encoder->xyb);
+    hyd_freep(&encoder->lf_frame_samples);
+    hyd_freep(&encoder->preview_samples);
+    free_pyramid(encoder);
+    free_tile_cache(encoder);
     hyd_free_arraybuffer_p(encoder->lfg_perm_array, &encoder->lfg_perm);
     hyd_free_arraybuffer_p(encoder->lfg_array, &encoder->lfg);
     hyd_freep(&encoder->input_lut8);
     hyd_freep(&encoder->input_lut16);
     hyd_freep(&encoder->bias_cbrtf_lut);
     hyd_freep(&encoder->icc_data);
+    hyd_freep(&encoder->hf_mult_field);
+    hyd_freep(&encoder->ac_strategy);
     if (encoder->hf_coeffs) {
         for (size_t i = 0; i < encoder->num_hf_coeff_bw; i++)
-            hyd_freep(&encoder->hf_coeffs[i].buffer);
+            hyd_bitwriter_release(&encoder->hf_coeffs[i]);
     }
     hyd_freep(&encoder->hf_coeffs);
+    hyd_page_pool_free(&encoder->page_pool);
     hyd_freep(&encoder);
 
     return HYD_OK;
@@ -45,6 +70,16 @@ HYDRIUM_EXPORT HYDStatusCode hyd_encoder_destroy(HYDEncoder *encoder) {
 
 HYDRIUM_EXPORT HYDStatusCode hyd_set_metadata(HYDEncoder *encoder, const HYDImageMetadata *metadata) {
     HYDStatusCode ret = HYD_OK;
+    /* the pyramid levels are sized for the image and tiles it was set up with */
+    if (encoder->pyramid) {
+        encoder->error = "metadata can't be changed while a pyramid is set";
+        return HYD_API_ERROR;
+    }
+    /* the cached frames only stand in for tiles of the same frame settings, in tiled mode */
+    if (encoder->tile_cache) {
+        encoder->error = "metadata can't be changed while a tile cache is set";
+        return HYD_API_ERROR;
+    }
     if (!metadata->width || !metadata->height) {
         encoder->error = "invalid zero-width or zero-height";
         return HYD_API_ERROR;
@@ -76,9 +111,61 @@ HYDRIUM_EXPORT HYDStatusCode hyd_set_metadata(HYDEncoder *encoder, const HYDImag
         return HYD_API_ERROR;
     }
 
+    if (metadata->entropy_preset < 0 || metadata->entropy_preset > HYD_NUM_STATIC_PRESETS) {
+        encoder->error = "entropy_preset must be between 0 and 2";
+        return HYD_API_ERROR;
+    }
+
+    if (metadata->distance != 0.f && !(metadata->distance >= 0.1f && metadata->distance <= 25.f)) {
+        encoder->error = "distance must be 0, or between 0.1 and 25";
+        return HYD_API_ERROR;
+    }
+    if (metadata->effort < 0 || metadata->effort > 5) {
+        encoder->error = "effort must be between 0 and 5";
+        return HYD_API_ERROR;
+    }
+    if (metadata->upsampling < 0 || metadata->upsampling > 8 || (metadata->upsampling & (metadata->upsampling - 1))) {
+        encoder->error = "upsampling must be 0, 1, 2, 4, or 8";
+        return HYD_API_ERROR;
+    }
+    if (metadata->passes < 0 || metadata->passes > 3) {
+        encoder->error = "passes must be between 0 and 3";
+        return HYD_API_ERROR;
+    }
+    if (metadata->lf_frame && metadata->tile_size_shift_x >= 0 && metadata->tile_size_shift_y >= 0) {
+        encoder->error = "one-frame mode required for an LF frame";
+        return HYD_API_ERROR;
+    }
+    if (metadata->lf_frame && metadata->upsampling > 1) {
+        encoder->error = "an LF frame can't be used with upsampling";
+        return HYD_API_ERROR;
+    }
+    if (metadata->preview && metadata->tile_size_shift_x >= 0 && metadata->tile_size_shift_y >= 0) {
+        encoder->error = "one-frame mode required for a preview";
+        return HYD_API_ERROR;
+    }
+    encoder->upsampling_shift = metadata->upsampling > 1 ? hyd_fllog2(metadata->upsampling) : 0;
+    encoder->num_passes = metadata->passes > 1 ? metadata->passes : 1;
+    if (metadata->preview) {
+        const size_t coded_w = hyd_ceil_div(metadata->width, (size_t)1 << encoder->upsampling_shift);
+        const size_t coded_h = hyd_ceil_div(metadata->height, (size_t)1 << encoder->upsampling_shift);
+        const size_t longer = hyd_max(coded_w, coded_h);
+        encoder->preview_shift = 1;
+        while (hyd_ceil_div(longer, (size_t)1 << encoder->preview_shift) > 256)
+            encoder->preview_shift++;
+        encoder->preview_width = hyd_ceil_div(coded_w, (size_t)1 << encoder->preview_shift);
+        encoder->preview_height = hyd_ceil_div(coded_h, (size_t)1 << encoder->preview_shift);
+        hyd_freep(&encoder->preview_samples);
+    }
+    encoder->effort = metadata->effort ? metadata->effort : 3;
+    encoder->rdo_quant = encoder->effort >= 2;
+
+    hyd_set_distance(encoder, metadata->distance ? metadata->distance : 1.f);
+
     encoder->one_frame = metadata->tile_size_shift_x < 0 || metadata->tile_size_shift_y < 0;
-    encoder->lfg_count_y = (metadata->height + 2047) >> 11;
-    encoder->lfg_count_x = (metadata->width + 2047) >> 11;
+    const int lfg_shift = 11 + encoder->upsampling_shift;
+    encoder->lfg_count_y = (metadata->height + (1 << lfg_shift) - 1) >> lfg_shift;
+    encoder->lfg_count_x = (metadata->width + (1 << lfg_shift) - 1) >> lfg_shift;
     encoder->lfg_per_frame = encoder->one_frame ? encoder->lfg_count_y * encoder->lfg_count_x : 1;
     hyd_free_arraybuffer_p(encoder->lfg_array, &encoder->lfg);
     ret = hyd_malloc_arraybuffer_p(encoder->lfg_per_frame, sizeof(*encoder->lfg), encoder->lfg_array,
@@ -152,26 +239,376 @@ HYDRIUM_EXPORT HYDStatusCode hyd_flush(HYDEncoder *encoder) {
         return HYD_API_ERROR;
     }
     hyd_bitwriter_flush(&encoder->writer);
-    size_t tocopy = encoder->writer.buffer_len - encoder->writer.buffer_pos;
-    if (tocopy > encoder->working_writer.buffer_pos - encoder->copy_pos)
-        tocopy = encoder->working_writer.buffer_pos - encoder->copy_pos;
-    memcpy(encoder->writer.buffer + encoder->writer.buffer_pos,
-        encoder->working_writer.buffer + encoder->copy_pos, tocopy);
-    encoder->writer.buffer_pos += tocopy;
-    encoder->copy_pos += tocopy;
-    if (encoder->copy_pos >= encoder->working_writer.buffer_pos)
-        return HYD_OK;
-
-    return HYD_NEED_MORE_OUTPUT;
+    return hyd_bitwriter_take(&encoder->working_writer, &encoder->copy_pos, &encoder->writer);
 }
 
 HYDRIUM_EXPORT const char *hyd_error_message_get(HYDEncoder *encoder) {
     return encoder->error;
 }
 
+/*
+ * Encode one tile of a pyramid level, whose XYB is in rows of stride entries, as an image of its own,
+ * and pass it to the callback.
+ */
+static HYDStatusCode send_pyramid_tile(HYDEncoder *encoder, int level, uint32_t tile_x, uint32_t tile_y,
+                                       const XYBEntry *xyb, size_t stride, size_t width, size_t height) {
+    HYDStatusCode ret;
+    size_t out_len = 1 << 16;
+    size_t out_pos = 0;
+    size_t written = 0;
+    uint8_t *out = malloc(out_len);
+    HYDEncoder *sub = hyd_encoder_new();
+    if (!out || !sub) {
+        ret = HYD_NOMEM;
+        goto end;
+    }
+
+    HYDImageMetadata metadata = encoder->metadata;
+    metadata.width = width;
+    metadata.height = height;
+    metadata.tile_size_shift_x = -1;
+    metadata.tile_size_shift_y = -1;
+    ret = hyd_set_metadata(sub, &metadata);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    /* the ICC profile is kept already encoded, so it's copied over as is */
+    if (encoder->icc_data) {
+        sub->icc_data = malloc(encoder->icc_size);
+        if (!sub->icc_data) {
+            ret = HYD_NOMEM;
+            goto end;
+        }
+        memcpy(sub->icc_data, encoder->icc_data, encoder->icc_size);
+        sub->icc_size = encoder->icc_size;
+    }
+    ret = hyd_provide_output_buffer(sub, out, out_len);
+    if (ret < HYD_ERROR_START)
+        goto end;
+    ret = hyd_send_tile_pre(sub, 0, 0, 1);
+    if (ret < HYD_ERROR_START)
+        goto end;
+
+    /* the level is already XYB, so this skips hyd_populate_xyb_buffer */
+    for (size_t y = 0; y < height; y++)
+        memcpy(&sub->xyb[y * sub->lfg->stride], &xyb[y * stride], width * sizeof(XYBEntry));
+    hyd_pad_xyb_buffer(sub, 0);
+    sub->lfg_perm[0] = 0;
+    hyd_transform_xyb_buffer(sub, 0, 0);
+    ret = hyd_encode_xyb_buffer(sub, 0, 0);
+    while (ret == HYD_NEED_MORE_OUTPUT) {
+        hyd_release_output_buffer(sub, &written);
+        out_pos += written;
+        ret = hyd_realloc_p(&out, out_len << 1);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        out_len <<= 1;
+        ret = hyd_provide_output_buffer(sub, out + out_pos, out_len - out_pos);
+        if (ret < HYD_ERROR_START)
+            goto end;
+        ret = hyd_flush(sub);
+    }
+    if (ret < HYD_ERROR_START)
+        goto end;
+    hyd_release_output_buffer(sub, &written);
+    out_pos += written;
+
+    ret = encoder->pyramid_callback(encoder->pyramid_opaque, level, tile_x, tile_y, out, out_pos);
+    if (ret < HYD_ERROR_START)
+        encoder->error = "pyramid callback failed";
+
+end:
+    if (sub && ret < HYD_ERROR_START && sub->error)
+        encoder->error = sub->error;
+    hyd_encoder_destroy(sub);
+    hyd_freep(&out);
+    return ret;
+}
+
+/*
+ * Add the tile in the XYB buffer to each pyramid level, and once that fills a row of tiles of a level,
+ * average it out, and send its tiles.
+ */
+static HYDStatusCode check_pyramid_row(HYDEncoder *encoder, uint32_t tile_y) {
+    for (int k = 1; k <= encoder->pyramid_levels; k++) {
+        const HYDPyramidLevel *level = &encoder->pyramid[k - 1];
+        if (level->tiles_in && level->row_y != tile_y >> k) {
+            encoder->error = "pyramid mode requires tiles to be sent a row at a time";
+            return HYD_API_ERROR;
+        }
+    }
+
+    return HYD_OK;
+}
+
+static HYDStatusCode add_pyramid_tile(HYDEncoder *encoder, uint32_t tile_y) {
+    HYDStatusCode ret;
+    const size_t tile_w = encoder->lfg->tile_count_x << 8;
+    const size_t tile_h = encoder->lfg->tile_count_y << 8;
+    const size_t tiles_x = hyd_ceil_div(encoder->metadata.width, tile_w);
+    const size_t tiles_y = hyd_ceil_div(encoder->metadata.height, tile_h);
+
+    for (int k = 1; k <= encoder->pyramid_levels; k++)
+        encoder->pyramid[k - 1].row_y = tile_y >> k;
+
+    hyd_populate_pyramid(encoder);
+
+    for (int k = 1; k <= encoder->pyramid_levels; k++) {
+        HYDPyramidLevel *level = &encoder->pyramid[k - 1];
+        const size_t rows_in = hyd_min((size_t)1 << k, tiles_y - (level->row_y << k));
+        if (++level->tiles_in < tiles_x * rows_in)
+            continue;
+        const size_t y0 = level->row_y * tile_h;
+        const size_t height = hyd_min(tile_h, level->height - y0);
+        for (size_t y = 0; y < height; y++) {
+            const size_t rows = hyd_min(encoder->metadata.height - ((y0 + y) << k), (size_t)1 << k);
+            for (size_t x = 0; x < level->width; x++) {
+                const size_t cols = hyd_min(encoder->metadata.width - (x << k), (size_t)1 << k);
+                const float scale = 1.f / (rows * cols);
+                XYBEntry *entry = &level->row[y * level->width + x];
+                entry->xyb[0].f *= scale;
+                entry->xyb[1].f *= scale;
+                entry->xyb[2].f *= scale;
+            }
+        }
+        for (size_t x0 = 0; x0 < level->width; x0 += tile_w) {
+            ret = send_pyramid_tile(encoder, k, x0 / tile_w, level->row_y, &level->row[x0], level->width,
+                hyd_min(tile_w, level->width - x0), height);
+            if (ret < HYD_ERROR_START)
+                return ret;
+        }
+        memset(level->row, 0, tile_h * level->width * sizeof(*level->row));
+        level->tiles_in = 0;
+    }
+
+    return HYD_OK;
+}
+
+/* encoders can only share a tile's XYB conversion and DCT if they agree on everything that goes into them */
+static int same_xyb_buffer(const HYDEncoder *a, const HYDEncoder *b) {
+    if (!a->lfg || !b->lfg)
+        return 0;
+    if (a->metadata.width != b->metadata.width || a->metadata.height != b->metadata.height)
+        return 0;
+    if (!a->metadata.linear_light != !b->metadata.linear_light || a->upsampling_shift != b->upsampling_shift)
+        return 0;
+    if (a->one_frame != b->one_frame)
+        return 0;
+    return a->one_frame || (a->lfg->tile_count_x == b->lfg->tile_count_x
+        && a->lfg->tile_count_y == b->lfg->tile_count_y);
+}
+
+HYDRIUM_EXPORT HYDStatusCode hyd_send_tile_multi(HYDEncoder *const encoders[], size_t count,
+    const void *const buffer[3], uint32_t tile_x, uint32_t tile_y, ptrdiff_t row_stride,
+    ptrdiff_t pixel_stride, int is_last, HYDSampleFormat sample_fmt) {
+    HYDStatusCode ret;
+
+    /* there is no encoder to carry an error message */
+    if (!count)
+        return HYD_API_ERROR;
+
+    /* the first encoder converts and transforms the tile for all of them */
+    HYDEncoder *const encoder = encoders[0];
+
+    if (sample_fmt != HYD_UINT8 && sample_fmt != HYD_UINT16 && sample_fmt != HYD_FLOAT32) {
+        encoder->error = "Invalid Sample Format";
+        return HYD_API_ERROR;
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        if (!same_xyb_buffer(encoder, encoders[i])) {
+            encoders[i]->error = "encoders must match the first one in size, tiling, linear light, and upsampling";
+            return HYD_API_ERROR;
+        }
+    }
+
+    /* nothing may be written before every encoder has accepted the tile */
+    for (size_t i = 0; i < count; i++) {
+        if (encoders[i]->pyramid_levels) {
+            ret = check_pyramid_row(encoders[i], tile_y);
+            if (ret < HYD_ERROR_START)
+                return ret;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        ret = hyd_send_tile_pre(encoders[i], tile_x, tile_y, is_last);
+        if (ret < HYD_ERROR_START)
+            return ret;
+    }
+
+    size_t lfid = encoder->one_frame ? tile_y * encoder->lfg_count_x + tile_x : 0;
+
+    /* tiles found in an encoder's tile cache skip everything but the pyramid */
+    int hashed = 0, need_xyb = 0, need_dct = 0;
+    uint64_t key = 0;
+    for (size_t i = 0; i < count; i++) {
+        HYDEncoder *const variant = encoders[i];
+        variant->tile_cached = 0;
+        if (variant->tile_cache) {
+            if (!hashed) {
+                key = hyd_hash_tile(encoder, buffer, row_stride, pixel_stride, lfid, sample_fmt);
+                hashed = 1;
+            }
+            HYDCachedTile *slot = &variant->tile_cache[key % variant->tile_cache_slots];
+            variant->tile_key = key;
+            variant->tile_cached = slot->size && slot->key == key && hyd_tile_samples_match(encoder, slot,
+                buffer, row_stride, pixel_stride, lfid, sample_fmt);
+            if (!variant->tile_cached)
+                hyd_store_tile_samples(encoder, slot, buffer, row_stride, pixel_stride, lfid, sample_fmt);
+        }
+        need_dct |= !variant->tile_cached;
+        need_xyb |= !variant->tile_cached || variant->pyramid_levels;
+    }
+
+    if (need_xyb) {
+        ret = hyd_populate_xyb_buffer(encoder, buffer, row_stride, pixel_stride, lfid, sample_fmt);
+        if (ret < HYD_ERROR_START)
+            return ret;
+    }
+
+    const HYDLFGroup *lf_group = &encoder->lfg[lfid];
+    const size_t xyb_size = lf_group->varblock_height * lf_group->varblock_width * 64 * sizeof(XYBEntry);
+
+    for (size_t i = 0; i < count; i++) {
+        HYDEncoder *const variant = encoders[i];
+        /* only the preview and the pyramid need the pixels, rather than the DCT of them */
+        if (!variant->metadata.preview && !variant->pyramid_levels)
+            continue;
+        if (i)
+            memcpy(variant->xyb, encoder->xyb, xyb_size);
+        if (variant->metadata.preview) {
+            ret = hyd_populate_preview(variant, lfid);
+            if (ret < HYD_ERROR_START)
+                return ret;
+        }
+        if (variant->pyramid_levels) {
+            ret = add_pyramid_tile(variant, tile_y);
+            if (ret < HYD_ERROR_START)
+                return ret;
+        }
+    }
+
+    if (need_dct)
+        hyd_transform_xyb_buffer(encoder, tile_x, tile_y);
+    for (size_t i = 1; i < count; i++) {
+        if (!encoders[i]->tile_cached)
+            memcpy(encoders[i]->xyb, encoder->xyb, xyb_size);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        HYDEncoder *const variant = encoders[i];
+        if (variant->one_frame)
+            variant->lfg_perm[variant->tiles_sent] = lfid;
+
+        if (variant->tile_cached)
+            ret = hyd_encode_cached_tile(variant);
+        else
+            ret = hyd_encode_xyb_buffer(variant, tile_x, tile_y);
+        if (ret < HYD_ERROR_START)
+            return ret;
+
+        if (variant->one_frame)
+            variant->tiles_sent++;
+    }
+
+    return HYD_OK;
+}
+
 HYDRIUM_EXPORT HYDStatusCode hyd_send_tile(HYDEncoder *encoder, const void *const buffer[3],
     uint32_t tile_x, uint32_t tile_y, ptrdiff_t row_stride,
     ptrdiff_t pixel_stride, int is_last, HYDSampleFormat sample_fmt) {
+    return hyd_send_tile_multi(&encoder, 1, buffer, tile_x, tile_y, row_stride, pixel_stride, is_last, sample_fmt);
+}
+
+HYDRIUM_EXPORT HYDStatusCode hyd_set_target_size(HYDEncoder *encoder, size_t target_size) {
+    if (encoder->wrote_header) {
+        encoder->error = "target size must be set before any tiles are sent";
+        return HYD_API_ERROR;
+    }
+    encoder->target_size = target_size;
+    return HYD_OK;
+}
+
+HYDRIUM_EXPORT HYDStatusCode hyd_set_pyramid(HYDEncoder *encoder, int levels, HYDPyramidCallback callback,
+                                             void *opaque) {
+    if (encoder->wrote_header) {
+        encoder->error = "pyramid must be set before any tiles are sent";
+        return HYD_API_ERROR;
+    }
+    free_pyramid(encoder);
+    if (!levels)
+        return HYD_OK;
+    if (!encoder->lfg) {
+        encoder->error = "metadata must be set before the pyramid";
+        return HYD_API_ERROR;
+    }
+    if (encoder->one_frame) {
+        encoder->error = "tiled mode required for a pyramid";
+        return HYD_API_ERROR;
+    }
+    if (encoder->upsampling_shift) {
+        encoder->error = "a pyramid can't be used with upsampling";
+        return HYD_API_ERROR;
+    }
+    const size_t longer = hyd_max(encoder->metadata.width, encoder->metadata.height);
+    if (levels < 0 || levels > hyd_cllog2(longer)) {
+        encoder->error = "pyramid levels must be between 0 and what it takes to get down to one pixel";
+        return HYD_API_ERROR;
+    }
+    if (!callback) {
+        encoder->error = "callback may not be null";
+        return HYD_API_ERROR;
+    }
+
+    encoder->pyramid = calloc(levels, sizeof(*encoder->pyramid));
+    if (!encoder->pyramid)
+        return HYD_NOMEM;
+    encoder->pyramid_levels = levels;
+    const size_t tile_h = encoder->lfg->tile_count_y << 8;
+    for (int k = 1; k <= levels; k++) {
+        HYDPyramidLevel *level = &encoder->pyramid[k - 1];
+        level->width = hyd_ceil_div(encoder->metadata.width, (size_t)1 << k);
+        level->height = hyd_ceil_div(encoder->metadata.height, (size_t)1 << k);
+        level->row = calloc(tile_h * level->width, sizeof(*level->row));
+        if (!level->row) {
+            free_pyramid(encoder);
+            return HYD_NOMEM;
+        }
+    }
+    encoder->pyramid_callback = callback;
+    encoder->pyramid_opaque = opaque;
+
+    return HYD_OK;
+}
+
+HYDRIUM_EXPORT HYDStatusCode hyd_set_tile_cache(HYDEncoder *encoder, size_t slots) {
+    if (encoder->wrote_header) {
+        encoder->error = "tile cache must be set before any tiles are sent";
+        return HYD_API_ERROR;
+    }
+    free_tile_cache(encoder);
+    if (!slots)
+        return HYD_OK;
+    if (!encoder->lfg) {
+        encoder->error = "metadata must be set before the tile cache";
+        return HYD_API_ERROR;
+    }
+    if (encoder->one_frame) {
+        encoder->error = "tiled mode required for a tile cache";
+        return HYD_API_ERROR;
+    }
+
+    encoder->tile_cache = calloc(slots, sizeof(*encoder->tile_cache));
+    if (!encoder->tile_cache)
+        return HYD_NOMEM;
+    encoder->tile_cache_slots = slots;
+
+    return HYD_OK;
+}
+
+HYDRIUM_EXPORT HYDStatusCode hyd_estimate_size(HYDEncoder *encoder, const void *const buffer[3],
+    uint32_t tile_x, uint32_t tile_y, ptrdiff_t row_stride,
+    ptrdiff_t pixel_stride, HYDSampleFormat sample_fmt, size_t *size) {
     HYDStatusCode ret;
 
     if (sample_fmt != HYD_UINT8 && sample_fmt != HYD_UINT16 && sample_fmt != HYD_FLOAT32) {
@@ -179,27 +616,23 @@ HYDRIUM_EXPORT HYDStatusCode hyd_send_tile(HYDEncoder *encoder, const void *cons
         return HYD_API_ERROR;
     }
 
-    ret = hyd_send_tile_pre(encoder, tile_x, tile_y, is_last);
+    HYDLFGroup *lf_group = NULL;
+    ret = hyd_populate_lf_group(encoder, &lf_group, tile_x, tile_y);
     if (ret < HYD_ERROR_START)
         return ret;
 
-    size_t lfid = encoder->one_frame ? tile_y * encoder->lfg_count_x + tile_x : 0;
-
-    ret = hyd_populate_xyb_buffer(encoder, buffer, row_stride, pixel_stride, lfid, sample_fmt);
+    size_t xyb_pixels = lf_group->varblock_height * lf_group->varblock_width * 64;
+    ret = hyd_realloc_array_p(&encoder->xyb, xyb_pixels, sizeof(XYBEntry));
     if (ret < HYD_ERROR_START)
         return ret;
 
-    if (encoder->one_frame)
-        encoder->lfg_perm[encoder->tiles_sent] = lfid;
+    size_t lfid = encoder->one_frame ? tile_y * encoder->lfg_count_x + tile_x : 0;
 
-    ret = hyd_encode_xyb_buffer(encoder, tile_x, tile_y);
+    ret = hyd_populate_xyb_buffer(encoder, buffer, row_stride, pixel_stride, lfid, sample_fmt);
     if (ret < HYD_ERROR_START)
         return ret;
 
-    if (encoder->one_frame)
-        encoder->tiles_sent++;
-
-    return HYD_OK;
+    return hyd_estimate_xyb_buffer(encoder, tile_x, tile_y, size);
 }
 
 static inline uint8_t header_predict(const uint8_t *header, uint32_t icc_size, unsigned int i)
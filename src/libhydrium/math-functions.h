@@ -76,6 +76,16 @@ static inline int hyd_isfinite(const float x) {
     return (z.i & 0x7f800000u) != 0x7f800000u;
 }
 
+/* log2 of a positive, finite x, good to about 1e-4 */
+static inline float hyd_log2f(const float x) {
+    union { uint32_t i; float f; } z = { .f = x };
+    const float exponent = (int32_t)(z.i >> 23) - 127;
+    z.i = (z.i & 0x7fffffu) | 0x3f800000u;
+    const float m = z.f;
+    return exponent - 2.7868212f + (5.0469017f + (-3.4925256f + (1.5939200f
+        + (-0.40487258f + 0.043429512f * m) * m) * m) * m) * m;
+}
+
 #define hyd_ceil_div(num, den) (((num) + (den) - 1) / (den))
 #define hyd_abs(a) ((a) < 0 ? -(a) : (a))
 #define hyd_array_size(a) (sizeof((a))/sizeof(*(a)))
@@ -0,0 +1,511 @@
+/*
+ * libhydrium static-codes.c
+ *
+ * Built-in prefix codes, trained offline on photographs and on screenshots and diagrams.
+ */
+#include <stdint.h>
+
+#include "static-codes.h"
+
+static const uint8_t photo_hf0[72] = {
+    1, 3, 3, 5, 6, 7, 7, 7, 9, 7, 9, 6, 10, 11, 7, 11, 6, 5, 6, 5, 11, 11, 11, 11,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+};
+
+static const uint8_t photo_hf1[72] = {
+    2, 2, 2, 3, 4, 6, 7, 7, 7, 8, 9, 9, 9, 8, 10, 11, 8, 10, 12, 15, 15, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf2[72] = {
+    3, 4, 3, 3, 3, 3, 4, 3, 5, 5, 6, 7, 7, 8, 8, 9, 7, 8, 9, 8, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf3[72] = {
+    6, 6, 6, 5, 5, 4, 3, 3, 3, 4, 4, 4, 4, 4, 5, 5, 4, 7, 8, 11, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf4[72] = {
+    7, 8, 8, 8, 8, 8, 7, 6, 7, 6, 6, 6, 5, 5, 5, 5, 1, 3, 3, 6, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf5[72] = {
+    1, 2, 3, 5, 5, 7, 7, 9, 8, 10, 10, 10, 10, 12, 12, 11, 7, 9, 11, 11, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+};
+
+static const uint8_t photo_hf6[72] = {
+    2, 2, 2, 3, 4, 5, 7, 7, 8, 9, 9, 11, 9, 10, 13, 14, 13, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf7[72] = {
+    3, 4, 3, 2, 3, 3, 4, 4, 5, 6, 8, 8, 11, 11, 11, 11, 10, 10, 11, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13,
+};
+
+static const uint8_t photo_hf8[72] = {
+    5, 6, 5, 5, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 8, 9, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+};
+
+static const uint8_t photo_hf9[72] = {
+    5, 9, 8, 8, 9, 8, 8, 6, 6, 5, 4, 4, 3, 3, 3, 3, 2, 8, 9, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf10[72] = {
+    1, 2, 3, 4, 6, 7, 10, 10, 9, 10, 8, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 10,
+};
+
+static const uint8_t photo_hf11[72] = {
+    2, 1, 3, 4, 5, 6, 7, 10, 9, 13, 13, 14, 14, 12, 14, 14, 12, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf12[72] = {
+    4, 3, 2, 2, 3, 4, 4, 5, 7, 7, 8, 9, 9, 9, 11, 14, 9, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf13[72] = {
+    7, 7, 6, 5, 4, 3, 3, 2, 3, 3, 4, 5, 7, 7, 8, 10, 7, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf14[72] = {
+    2, 3, 5, 8, 4, 5, 4, 5, 7, 5, 4, 4, 6, 4, 5, 14, 3, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf15[72] = {
+    2, 14, 14, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 7, 6, 4, 4, 4, 4, 4, 5, 5, 5,
+    5, 6, 6, 8, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf16[72] = {
+    1, 15, 15, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 4, 5, 5, 6, 7, 8, 8, 9,
+    9, 10, 12, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf17[72] = {
+    1, 14, 14, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 7, 7, 7, 5, 6, 7, 8, 8, 10, 10, 14,
+    14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf18[72] = {
+    3, 14, 14, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 3, 4, 3, 4, 4, 5, 4, 6,
+    6, 7, 8, 11, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf19[72] = {
+    2, 14, 14, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 3, 4, 4, 5, 5, 6, 6, 7,
+    8, 11, 12, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf20[72] = {
+    1, 15, 15, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 4, 5, 5, 7, 8, 10, 12, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf21[72] = {
+    2, 14, 14, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 6, 3, 4, 4, 6, 6, 7, 8, 13,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf22[72] = {
+    1, 15, 15, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 7, 7, 5, 6, 7, 10, 8, 12, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf23[72] = {
+    1, 13, 13, 3, 3, 4, 4, 5, 6, 6, 6, 7, 7, 8, 8, 8, 7, 10, 8, 12, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf24[72] = {
+    2, 14, 14, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 6, 6, 3, 4, 5, 6, 7, 9, 12, 14,
+    14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf25[72] = {
+    1, 15, 15, 4, 4, 5, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 4, 6, 8, 10, 10, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf26[72] = {
+    1, 14, 14, 3, 4, 4, 4, 5, 5, 5, 6, 6, 6, 7, 7, 8, 6, 8, 8, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf27[72] = {
+    2, 15, 15, 4, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 3, 4, 5, 6, 7, 8, 10, 10,
+    13, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf28[72] = {
+    1, 15, 15, 3, 3, 4, 4, 5, 5, 6, 7, 7, 7, 8, 9, 10, 7, 8, 9, 13, 15, 14, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf29[72] = {
+    1, 13, 13, 2, 3, 5, 5, 7, 6, 6, 8, 11, 9, 12, 8, 9, 8, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 12,
+};
+
+static const uint8_t photo_hf30[72] = {
+    2, 15, 15, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 3, 5, 5, 6, 7, 9, 9, 11,
+    11, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t photo_hf31[72] = {
+    1, 14, 14, 4, 3, 4, 4, 5, 5, 6, 5, 6, 6, 7, 7, 8, 6, 8, 9, 10, 13, 13, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_hf32[72] = {
+    1, 14, 14, 3, 3, 4, 4, 5, 6, 6, 7, 8, 8, 6, 7, 8, 6, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t photo_lf[228] = {
+    3, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 10, 9, 10, 10, 10, 9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 10, 11, 11, 10, 11, 10, 11, 11,
+    11, 11, 11, 10, 11, 11, 10, 11, 7, 6, 8, 7, 8, 8, 9, 9, 9, 9, 10, 10, 13, 11, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf0[72] = {
+    1, 7, 9, 8, 7, 7, 6, 5, 9, 9, 9, 7, 7, 7, 8, 7, 5, 4, 3, 4, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+};
+
+static const uint8_t graphics_hf1[72] = {
+    2, 1, 5, 4, 3, 8, 9, 12, 12, 10, 14, 14, 14, 14, 10, 9, 8, 9, 7, 9, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf2[72] = {
+    1, 7, 8, 12, 7, 4, 3, 2, 11, 10, 10, 9, 10, 12, 11, 12, 9, 7, 6, 7, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf3[72] = {
+    1, 9, 9, 9, 6, 5, 4, 3, 9, 8, 7, 7, 6, 6, 6, 6, 4, 5, 4, 6, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf4[72] = {
+    2, 10, 11, 10, 9, 9, 7, 4, 10, 10, 10, 10, 9, 9, 9, 8, 5, 3, 2, 2, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf5[72] = {
+    1, 6, 6, 5, 5, 5, 5, 6, 7, 7, 6, 6, 6, 7, 7, 7, 5, 8, 9, 9, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+};
+
+static const uint8_t graphics_hf6[72] = {
+    1, 3, 3, 4, 4, 5, 6, 7, 6, 8, 7, 7, 7, 7, 8, 8, 7, 11, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13,
+};
+
+static const uint8_t graphics_hf7[72] = {
+    1, 6, 6, 5, 5, 4, 3, 4, 5, 5, 6, 6, 6, 7, 7, 7, 6, 8, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf8[72] = {
+    2, 7, 6, 6, 5, 5, 4, 4, 5, 5, 4, 4, 4, 5, 4, 5, 3, 6, 10, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 12, 12, 12,
+};
+
+static const uint8_t graphics_hf9[72] = {
+    2, 9, 9, 8, 7, 6, 4, 5, 7, 6, 5, 5, 5, 5, 5, 4, 2, 3, 8, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf10[72] = {
+    1, 3, 4, 5, 5, 5, 6, 6, 7, 8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+};
+
+static const uint8_t graphics_hf11[72] = {
+    1, 3, 4, 3, 4, 4, 5, 6, 7, 9, 10, 10, 14, 14, 14, 13, 12, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf12[72] = {
+    2, 5, 4, 3, 3, 3, 3, 4, 5, 6, 6, 7, 8, 8, 9, 9, 8, 10, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 12, 12,
+};
+
+static const uint8_t graphics_hf13[72] = {
+    2, 6, 6, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 6, 5, 4, 7, 10, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 12, 12, 12,
+};
+
+static const uint8_t graphics_hf14[72] = {
+    1, 10, 11, 9, 9, 8, 8, 7, 7, 7, 6, 5, 5, 5, 4, 5, 3, 3, 7, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf15[72] = {
+    1, 15, 15, 8, 8, 8, 8, 9, 8, 8, 8, 7, 8, 7, 8, 8, 6, 5, 5, 5, 4, 5, 4, 5,
+    4, 5, 5, 6, 8, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf16[72] = {
+    1, 14, 14, 6, 6, 7, 6, 7, 7, 7, 7, 7, 6, 7, 7, 7, 5, 5, 4, 5, 5, 5, 5, 5,
+    4, 6, 8, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf17[72] = {
+    1, 15, 15, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 7, 4, 5, 6, 7, 6, 7, 8, 10,
+    15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf18[72] = {
+    2, 14, 14, 7, 6, 7, 6, 7, 7, 7, 7, 7, 7, 6, 7, 7, 5, 5, 4, 4, 4, 4, 3, 4,
+    4, 5, 6, 7, 8, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf19[72] = {
+    3, 14, 14, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7, 3, 4, 3, 4, 3, 4, 4, 5,
+    6, 8, 10, 13, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf20[72] = {
+    2, 15, 15, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 3, 4, 4, 5, 5, 7, 8, 10,
+    14, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf21[72] = {
+    1, 14, 14, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 4, 5, 4, 5, 6, 7, 6, 8,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf22[72] = {
+    1, 14, 14, 3, 4, 5, 4, 5, 5, 6, 6, 6, 7, 7, 7, 8, 5, 6, 6, 8, 7, 9, 12, 14,
+    14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf23[72] = {
+    1, 14, 14, 3, 3, 4, 4, 5, 6, 6, 6, 7, 7, 8, 8, 10, 6, 11, 13, 14, 14, 14, 14, 14,
+    14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf24[72] = {
+    2, 14, 14, 4, 4, 5, 5, 5, 5, 5, 5, 6, 5, 6, 5, 6, 3, 4, 4, 5, 5, 7, 8, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf25[72] = {
+    1, 15, 15, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 4, 5, 5, 7, 8, 10, 13, 15,
+    15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf26[72] = {
+    1, 15, 15, 3, 3, 4, 4, 5, 6, 6, 6, 7, 7, 8, 8, 8, 6, 10, 12, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf27[72] = {
+    2, 14, 14, 4, 4, 5, 4, 5, 5, 6, 5, 6, 5, 6, 6, 6, 3, 4, 4, 5, 5, 7, 9, 14,
+    14, 14, 14, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+};
+
+static const uint8_t graphics_hf28[72] = {
+    1, 14, 14, 4, 3, 4, 4, 5, 5, 6, 6, 7, 6, 7, 7, 7, 5, 7, 8, 11, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 13, 13,
+};
+
+static const uint8_t graphics_hf29[72] = {
+    1, 13, 13, 3, 3, 4, 4, 5, 5, 7, 6, 8, 7, 8, 8, 9, 8, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+};
+
+static const uint8_t graphics_hf30[72] = {
+    2, 13, 13, 4, 4, 5, 4, 5, 5, 5, 5, 6, 5, 6, 6, 6, 3, 4, 4, 5, 7, 6, 11, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+};
+
+static const uint8_t graphics_hf31[72] = {
+    1, 15, 15, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 5, 6, 8, 10, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_hf32[72] = {
+    1, 14, 14, 3, 3, 4, 4, 5, 5, 6, 7, 7, 7, 8, 8, 8, 7, 11, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const uint8_t graphics_lf[228] = {
+    1, 5, 4, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 10, 9, 10, 10, 10, 10, 10, 9, 10, 10, 10, 10, 10,
+    9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 10, 10, 10, 10, 10, 11, 11, 10, 11, 10, 10, 10,
+    11, 11, 11, 10, 10, 10, 11, 11, 6, 6, 7, 7, 6, 6, 7, 7, 8, 8, 10, 10, 11, 11, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+};
+
+const HYDStaticPreset hyd_static_presets[HYD_NUM_STATIC_PRESETS] = {
+    /* photographs and other continuous-tone images */
+    {
+        .hf = {
+            { { 4, 1, 0 }, 72, photo_hf0 },
+            { { 4, 1, 0 }, 72, photo_hf1 },
+            { { 4, 1, 0 }, 72, photo_hf2 },
+            { { 4, 1, 0 }, 72, photo_hf3 },
+            { { 4, 1, 0 }, 72, photo_hf4 },
+            { { 4, 1, 0 }, 72, photo_hf5 },
+            { { 4, 1, 0 }, 72, photo_hf6 },
+            { { 4, 1, 0 }, 72, photo_hf7 },
+            { { 4, 1, 0 }, 72, photo_hf8 },
+            { { 4, 1, 0 }, 72, photo_hf9 },
+            { { 4, 1, 0 }, 72, photo_hf10 },
+            { { 4, 1, 0 }, 72, photo_hf11 },
+            { { 4, 1, 0 }, 72, photo_hf12 },
+            { { 4, 1, 0 }, 72, photo_hf13 },
+            { { 4, 1, 0 }, 72, photo_hf14 },
+            { { 4, 1, 0 }, 72, photo_hf15 },
+            { { 4, 1, 0 }, 72, photo_hf16 },
+            { { 4, 1, 0 }, 72, photo_hf17 },
+            { { 4, 1, 0 }, 72, photo_hf18 },
+            { { 4, 1, 0 }, 72, photo_hf19 },
+            { { 4, 1, 0 }, 72, photo_hf20 },
+            { { 4, 1, 0 }, 72, photo_hf21 },
+            { { 4, 1, 0 }, 72, photo_hf22 },
+            { { 4, 1, 0 }, 72, photo_hf23 },
+            { { 4, 1, 0 }, 72, photo_hf24 },
+            { { 4, 1, 0 }, 72, photo_hf25 },
+            { { 4, 1, 0 }, 72, photo_hf26 },
+            { { 4, 1, 0 }, 72, photo_hf27 },
+            { { 4, 1, 0 }, 72, photo_hf28 },
+            { { 4, 1, 0 }, 72, photo_hf29 },
+            { { 4, 1, 0 }, 72, photo_hf30 },
+            { { 4, 1, 0 }, 72, photo_hf31 },
+            { { 4, 1, 0 }, 72, photo_hf32 },
+        },
+        .lf = { { 7, 1, 1 }, 228, photo_lf },
+    },
+    /* screenshots, diagrams, and other synthetic images */
+    {
+        .hf = {
+            { { 4, 1, 0 }, 72, graphics_hf0 },
+            { { 4, 1, 0 }, 72, graphics_hf1 },
+            { { 4, 1, 0 }, 72, graphics_hf2 },
+            { { 4, 1, 0 }, 72, graphics_hf3 },
+            { { 4, 1, 0 }, 72, graphics_hf4 },
+            { { 4, 1, 0 }, 72, graphics_hf5 },
+            { { 4, 1, 0 }, 72, graphics_hf6 },
+            { { 4, 1, 0 }, 72, graphics_hf7 },
+            { { 4, 1, 0 }, 72, graphics_hf8 },
+            { { 4, 1, 0 }, 72, graphics_hf9 },
+            { { 4, 1, 0 }, 72, graphics_hf10 },
+            { { 4, 1, 0 }, 72, graphics_hf11 },
+            { { 4, 1, 0 }, 72, graphics_hf12 },
+            { { 4, 1, 0 }, 72, graphics_hf13 },
+            { { 4, 1, 0 }, 72, graphics_hf14 },
+            { { 4, 1, 0 }, 72, graphics_hf15 },
+            { { 4, 1, 0 }, 72, graphics_hf16 },
+            { { 4, 1, 0 }, 72, graphics_hf17 },
+            { { 4, 1, 0 }, 72, graphics_hf18 },
+            { { 4, 1, 0 }, 72, graphics_hf19 },
+            { { 4, 1, 0 }, 72, graphics_hf20 },
+            { { 4, 1, 0 }, 72, graphics_hf21 },
+            { { 4, 1, 0 }, 72, graphics_hf22 },
+            { { 4, 1, 0 }, 72, graphics_hf23 },
+            { { 4, 1, 0 }, 72, graphics_hf24 },
+            { { 4, 1, 0 }, 72, graphics_hf25 },
+            { { 4, 1, 0 }, 72, graphics_hf26 },
+            { { 4, 1, 0 }, 72, graphics_hf27 },
+            { { 4, 1, 0 }, 72, graphics_hf28 },
+            { { 4, 1, 0 }, 72, graphics_hf29 },
+            { { 4, 1, 0 }, 72, graphics_hf30 },
+            { { 4, 1, 0 }, 72, graphics_hf31 },
+            { { 4, 1, 0 }, 72, graphics_hf32 },
+        },
+        .lf = { { 7, 1, 1 }, 228, graphics_lf },
+    },
+};
@@ -0,0 +1,20 @@
+/*
+ * Built-in prefix codes for single-pass encoding
+ */
+#ifndef HYD_STATIC_CODES_H_
+#define HYD_STATIC_CODES_H_
+
+#include "entropy.h"
+
+#define HYD_NUM_STATIC_PRESETS 2
+#define HYD_STATIC_HF_CLUSTERS 33
+
+typedef struct HYDStaticPreset {
+    HYDStaticCode hf[HYD_STATIC_HF_CLUSTERS];
+    HYDStaticCode lf;
+} HYDStaticPreset;
+
+/* entropy_preset N uses hyd_static_presets[N - 1] */
+extern const HYDStaticPreset hyd_static_presets[HYD_NUM_STATIC_PRESETS];
+
+#endif /* HYD_STATIC_CODES_H_ */